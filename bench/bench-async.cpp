@@ -0,0 +1,114 @@
+// -*- mode: c++ -*-
+////
+// Latency and throughput of the asynchronous batch front end under concurrent submitters: each submitter thread
+// keeps a window of Kepler propagation batches outstanding, and the time from submission to completion callback is
+// recorded per batch, along with the time the submit call itself held the caller.
+//
+//  usage: bench-async [batch-size [batches-per-submitter [window [workers]]]]
+//
+// The synchronous line is the same work through parallelFor on the calling thread, for reference.
+//
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "async.hpp"
+#include "parallel.hpp"
+#include "propagator.hpp"
+
+using namespace orbit;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+    auto percentile(std::vector<double> values, double fraction) -> double
+    {
+        if (values.empty()) return 0.0;
+        auto k = static_cast<std::size_t>(fraction*double(values.size() - 1));
+        std::nth_element(values.begin(), values.begin() + long(k), values.end());
+        return values[k];
+    }
+
+    auto microseconds(clock_type::duration d) -> double
+    {
+        return std::chrono::duration<double, std::micro>(d).count();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    auto batchSize = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000ul;
+    auto batches = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200ul;
+    auto window = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 4ul;
+    auto workers = argc > 4 ? unsigned(std::atoi(argv[4])) : 0u;
+
+    std::vector<StateVector<double>> states;
+    for (auto k = 0ul; k < batchSize; ++k) {
+        states.emplace_back(KeplerianElements<double>{7.0e6 + 3.0e4*double(k % 1000), 0.0005*double(k % 200),
+                                                      0.001*double(k), 0.01*double(k), 0.02*double(k),
+                                                      0.03*double(k)});
+    }
+    KeplerPropagator<double> propagator;
+
+    auto start = clock_type::now();
+    for (auto b = 0ul; b < batches; ++b) {
+        std::vector<StateVector<double>> result(batchSize);
+        numutil::parallelFor(batchSize, [&](std::size_t first, std::size_t last, unsigned) {
+            for (auto k = first; k < last; ++k) result[k] = propagator.propagate(states[k], 600.0);
+        }, workers);
+    }
+    std::chrono::duration<double> synchronous = clock_type::now() - start;
+
+    numutil::AsyncExecutor executor{workers, 8*window*batchSize, std::max(1ul, batchSize/8)};
+    std::cout << std::setprecision(4) << executor.workers() << " workers, batches of " << batchSize << ", window "
+              << window << "\n"
+              << "synchronous parallelFor: " << double(batches*batchSize)/synchronous.count() << " items/s\n"
+              << "submitters      items/s  latency p50 us  latency p99 us   submit p99 us\n";
+
+    for (auto submitters: {1u, 2u, 4u, 8u}) {
+        std::vector<std::vector<double>> latency(submitters, std::vector<double>(batches));
+        std::vector<std::vector<double>> submit(submitters, std::vector<double>(batches));
+        std::atomic<std::size_t> callbacks{0};
+        start = clock_type::now();
+        {
+            std::vector<std::jthread> threads;
+            for (auto s = 0u; s < submitters; ++s) {
+                threads.emplace_back([&, s] {
+                    std::deque<numutil::BatchResult<StateVector<double>>> outstanding;
+                    for (auto b = 0ul; b < batches; ++b) {
+                        if (outstanding.size() == window) {
+                            outstanding.front().wait();
+                            outstanding.pop_front();
+                        }
+                        auto submitted = clock_type::now();
+                        auto batch = propagateAsync(executor, propagator, states, 600.0);
+                        submit[s][b] = microseconds(clock_type::now() - submitted);
+                        batch.onComplete([&latency, &callbacks, s, b, submitted] {
+                            latency[s][b] = microseconds(clock_type::now() - submitted);
+                            ++callbacks;
+                        });
+                        outstanding.push_back(std::move(batch));
+                    }
+                    for (auto &batch: outstanding) batch.wait();
+                });
+            }
+        }
+        // Callbacks run just after waiters are released.
+        while (callbacks < submitters*batches) std::this_thread::yield();
+        std::chrono::duration<double> elapsed = clock_type::now() - start;
+
+        std::vector<double> allLatency, allSubmit;
+        for (auto s = 0u; s < submitters; ++s) {
+            allLatency.insert(allLatency.end(), latency[s].begin(), latency[s].end());
+            allSubmit.insert(allSubmit.end(), submit[s].begin(), submit[s].end());
+        }
+        std::cout << std::setw(10) << submitters << std::setw(13) << double(submitters*batches*batchSize)/elapsed.count()
+                  << std::setw(16) << percentile(allLatency, 0.5) << std::setw(16) << percentile(allLatency, 0.99)
+                  << std::setw(16) << percentile(allSubmit, 0.99) << "\n";
+    }
+    return 0;
+}
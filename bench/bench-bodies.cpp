@@ -0,0 +1,109 @@
+// -*- mode: c++ -*-
+////
+// Conversions and Kepler propagations per second with mu fixed at compile time (BodyElements, toState, toElements,
+// BodyKeplerPropagator) against the runtime mu path (KeplerianElements, StateVector, KeplerPropagator), single
+// threaded over batches of Earth orbits, in float and double.
+//
+//  usage: bench-bodies [objects]
+//
+// The runtime mu is read through a volatile so the compiler cannot fold it either.
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+#include "bodies.hpp"
+
+using namespace orbit;
+
+namespace {
+    volatile double runtimeMu = muEarth;
+
+    /// Best of three passes of body over count items, in items per second.
+    template<typename Body>
+    auto rate(std::size_t count, Body body) -> double
+    {
+        auto best = std::numeric_limits<double>::max();
+        for (auto pass = 0; pass < 3; ++pass) {
+            auto start = std::chrono::steady_clock::now();
+            body();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+        return double(count)/best;
+    }
+
+    auto report(const std::string &label, double runtime, double fixed) -> void
+    {
+        std::cout << "  " << std::left << std::setw(14) << label << std::right << std::setw(14) << runtime
+                  << std::setw(14) << fixed << std::setw(10) << fixed/runtime << "\n";
+    }
+
+    template<typename ScalarType>
+    auto run(const std::string &name, std::size_t objects) -> void
+    {
+        ScalarType mu = ScalarType(runtimeMu);
+        std::vector<KeplerianElements<ScalarType>> keplerian;
+        std::vector<BodyElements<Earth, ScalarType>> fixed;
+        keplerian.reserve(objects);
+        fixed.reserve(objects);
+        for (auto k = 0ul; k < objects; ++k) {
+            BodyElements<Earth, ScalarType> e{ScalarType(6.8e6 + 3.0e7*double(k % 1000)/1000.0),
+                                              ScalarType(0.7*double(k % 97)/97.0), ScalarType(0.001*double(k % 3000)),
+                                              ScalarType(0.01*double(k % 628)), ScalarType(0.02*double(k % 314)),
+                                              ScalarType(0.03*double(k % 209))};
+            fixed.push_back(e);
+            keplerian.emplace_back(e.semiMajorAxis, e.eccentricity, e.inclination, e.rightAscensionAscendingNode,
+                                   e.argumentOfPeriapsis, e.trueAnomaly, mu);
+        }
+        std::vector<StateVector<ScalarType>> states(objects), output(objects);
+        std::vector<BodyElements<Earth, ScalarType>> elementsOut(objects);
+        double checksum = 0;
+
+        std::cout << name << " (" << sizeof(KeplerianElements<ScalarType>) << " vs " << sizeof(BodyElements<Earth,
+                ScalarType>) << " bytes per element set)\n"
+                  << "  kernel         runtime mu/s  compile-time/s   speedup\n";
+
+        auto runtimeToState = rate(objects, [&] {
+            for (auto k = 0ul; k < objects; ++k) states[k] = StateVector<ScalarType>{keplerian[k]};
+        });
+        auto fixedToState = rate(objects, [&] {
+            for (auto k = 0ul; k < objects; ++k) output[k] = toState(fixed[k]);
+        });
+        report("toState", runtimeToState, fixedToState);
+
+        auto runtimeToElements = rate(objects, [&] {
+            for (auto k = 0ul; k < objects; ++k) checksum += KeplerianElements<ScalarType>{states[k], mu}.trueAnomaly;
+        });
+        auto fixedToElements = rate(objects, [&] {
+            for (auto k = 0ul; k < objects; ++k) elementsOut[k] = toElements<Earth>(states[k]);
+        });
+        report("toElements", runtimeToElements, fixedToElements);
+
+        KeplerPropagator<ScalarType> runtimePropagator{mu};
+        BodyKeplerPropagator<Earth, ScalarType> fixedPropagator;
+        auto runtimePropagate = rate(objects, [&] {
+            for (auto k = 0ul; k < objects; ++k) output[k] = runtimePropagator.propagate(states[k], ScalarType(600));
+        });
+        auto fixedPropagate = rate(objects, [&] {
+            for (auto k = 0ul; k < objects; ++k) output[k] = fixedPropagator.propagate(states[k], ScalarType(600));
+        });
+        report("propagate", runtimePropagate, fixedPropagate);
+
+        for (auto k = 0ul; k < objects; k += 997) checksum += double(output[k].r[0] + elementsOut[k].trueAnomaly);
+        if (checksum == 0.0) std::cout << "!\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    auto objects = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000ul;
+    std::cout << std::setprecision(4) << objects << " Earth orbits, single thread\n";
+    run<double>("double", objects);
+    run<float>("float", objects);
+    return 0;
+}
@@ -0,0 +1,98 @@
+// -*- mode: c++ -*-
+////
+// Update cycles over a large catalog: each cycle a fraction of the objects get new elements, then states are
+// wanted at a few fixed report epochs.  The incremental catalog recomputes only what changed; the reference
+// recomputes every state at every epoch, as a catalog without dirty tracking must.
+//
+//  usage: bench-catalog [objects [churn [cycles [epochs [threads]]]]]
+//
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "catalog.hpp"
+#include "parallel.hpp"
+#include "random.hpp"
+
+using namespace orbit;
+
+namespace {
+    /// LEO to GEO, near circular, random planes and phases.
+    auto randomElements(const numutil::Philox4x32 &generator, std::uint64_t counter) -> KeplerianElements<double>
+    {
+        auto w = generator.words(counter, 0);
+        auto u = numutil::Philox4x32::uniform(w[0]);
+        auto v = numutil::Philox4x32::uniform(w[1]);
+        auto x = numutil::Philox4x32::uniform(generator.words(counter, 2)[0]);
+        return {6.8e6 + 3.6e7*u*u, 0.02*v, 3.1*x, 6.28*u, 6.28*v, 6.28*x};
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    auto objects = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000ul;
+    auto churn = argc > 2 ? std::atof(argv[2]) : 0.02;
+    auto cycles = argc > 3 ? std::atoi(argv[3]) : 10;
+    auto epochs = argc > 4 ? std::atoi(argv[4]) : 3;
+    auto threads = argc > 5 ? unsigned(std::atoi(argv[5])) : 0u;
+
+    numutil::Philox4x32 generator{11};
+    IncrementalCatalog<double> catalog{std::size_t(epochs), threads};
+    std::vector<SecularJ2Propagator<double>> plain;
+    plain.reserve(objects);
+    for (auto k = 0ul; k < objects; ++k) {
+        auto elements = randomElements(generator, k);
+        catalog.add(elements, 0.0);
+        plain.emplace_back(elements, 0.0);
+    }
+    std::vector<double> reportEpochs;
+    for (auto e = 0; e < epochs; ++e) reportEpochs.push_back(3600.0*(e + 1));
+
+    // Warm every epoch so the cycles measure the steady state.
+    auto start = std::chrono::steady_clock::now();
+    for (auto t: reportEpochs) catalog.states(t);
+    std::chrono::duration<double> warm = std::chrono::steady_clock::now() - start;
+    catalog.resetStatistics();
+
+    auto changes = static_cast<std::size_t>(churn*double(objects));
+    std::vector<StateVector<double>> full(objects);
+    double incremental = 0, updating = 0, reference = 0, checksum = 0;
+    std::uint64_t counter = objects;
+    for (auto cycle = 0; cycle < cycles; ++cycle) {
+        start = std::chrono::steady_clock::now();
+        for (auto k = 0ul; k < changes; ++k, ++counter) {
+            auto id = generator.words(counter, 1)[0] % objects;
+            auto elements = randomElements(generator, counter);
+            catalog.update(id, elements, 0.0);
+            plain[id] = SecularJ2Propagator<double>{elements, 0.0};
+        }
+        updating += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (auto t: reportEpochs) checksum += catalog.states(t)[cycle].r[0];
+        incremental += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (auto t: reportEpochs) {
+            numutil::parallelFor(objects, [&](std::size_t begin, std::size_t end, unsigned) {
+                for (auto k = begin; k < end; ++k) full[k] = plain[k].propagate(t);
+            }, threads);
+            checksum -= full[cycle].r[0];
+        }
+        reference += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    const auto &stats = catalog.statistics();
+    std::cout << std::setprecision(4) << objects << " objects, " << 100.0*churn << "% churn, " << epochs
+              << " report epochs, " << cycles << " cycles, " << numutil::workerCount(objects, threads) << " threads\n"
+              << "initial fill of all epochs:      " << warm.count() << " s\n"
+              << "per cycle, full recompute:       " << reference/cycles << " s\n"
+              << "per cycle, incremental:          " << incremental/cycles << " s  (+ " << updating/cycles
+              << " s applying updates)\n"
+              << "speedup:                         " << reference/incremental << "\n"
+              << "hit rate " << 100.0*stats.hitRate() << "%, miss rate " << 100.0*stats.missRate() << "%, "
+              << stats.misses << " recomputed, " << stats.hits << " reused, " << stats.fullScans << " full scans\n"
+              << "consistency check (should be 0): " << checksum << "\n";
+    return 0;
+}
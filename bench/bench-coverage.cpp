@@ -0,0 +1,75 @@
+// -*- mode: c++ -*-
+////
+// Coverage of a Walker constellation of imaging satellites on a global raster, with the grid stored in square tiles
+// and in plain row major order.  Reports the time for each, footprints and covered cells rasterized per second, and
+// the coverage, revisit and gap statistics.
+//
+//  usage: bench-coverage [satellites [hours [step [resolution [threads [budget MB]]]]]]
+//
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numbers>
+#include <vector>
+#include "coverage.hpp"
+
+using namespace orbit;
+
+int main(int argc, char *argv[])
+{
+    auto satellites = argc > 1 ? std::atoi(argv[1]) : 1000;
+    auto hours = argc > 2 ? std::atof(argv[2]) : 24.0;
+    auto step = argc > 3 ? std::atof(argv[3]) : 30.0;
+    auto resolution = argc > 4 ? std::atof(argv[4]) : 0.1;
+    auto threads = argc > 5 ? unsigned(std::atoi(argv[5])) : 0u;
+    auto budget = argc > 6 ? std::size_t(std::atof(argv[6])*1.0e6) : std::size_t{1} << 30;
+
+    // 550 km, 53 degrees, 40 planes with phasing 1.
+    const auto degree = std::numbers::pi/180.0;
+    const auto planes = 40;
+    std::vector<SecularJ2Propagator<double>> constellation;
+    for (auto k = 0; k < satellites; ++k) {
+        auto plane = k % planes;
+        auto perPlane = (satellites + planes - 1)/planes;
+        auto slot = k/planes;
+        auto node = 2*std::numbers::pi*plane/planes;
+        auto anomaly = 2*std::numbers::pi*(slot + double(plane)/planes)/perPlane;
+        constellation.emplace_back(KeplerianElements<double>{6.928137e6, 0.0005, 53*degree, node, 0.0, anomaly});
+    }
+    Sensor sensor{30*degree, 20*degree};
+    auto end = hours*3600.0;
+
+    std::cout << std::setprecision(4) << satellites << " satellites, " << hours << " h every " << step << " s, "
+              << resolution << " degree cells, footprint radius " << sensor.footprintAngle(6.928137e6)/degree
+              << " degrees, " << numutil::workerCount(std::size_t(end/step) + 1, threads) << " threads, "
+              << double(budget)/1.0e6 << " MB for grids\n";
+
+    CoverageStatistics statistics;
+    for (auto tileSize: {std::size_t{32}, std::size_t{1}}) {
+        auto start = std::chrono::steady_clock::now();
+        auto report = computeCoverage<double>(constellation, sensor, 0.0, end, step, resolution, threads, tileSize,
+                                              budget);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::uint64_t cellSteps = 0;
+        for (std::size_t row = 0; row < report.grid.rows(); ++row) {
+            for (std::size_t column = 0; column < report.grid.columns(); ++column) {
+                cellSteps += report.grid.cell(row, column).covered;
+            }
+        }
+        auto footprints = double(report.steps)*satellites;
+        std::cout << (tileSize > 1 ? "tiled " : "row major ") << tileSize << "x" << tileSize << ": "
+                  << elapsed.count() << " s, " << footprints/elapsed.count()/1.0e3 << " k footprints/s, "
+                  << double(cellSteps)/elapsed.count()/1.0e6 << " M cells/s, " << report.blocks << " grids of "
+                  << double(CoverageGrid::storageBytes(resolution, tileSize))/1.0e6 << " MB\n";
+        statistics = report.statistics;
+    }
+
+    std::cout << "coverage " << 100.0*statistics.coverage << "%, time averaged " << 100.0*statistics.timeCoverage
+              << "%, revisited " << 100.0*statistics.revisited << "%\n"
+              << "mean revisit " << statistics.meanRevisit/60.0 << " min, mean gap " << statistics.meanGap/60.0
+              << " min, mean longest gap " << statistics.meanMaxGap/60.0 << " min, longest gap "
+              << statistics.maxGap/60.0 << " min\n";
+    return 0;
+}
@@ -0,0 +1,63 @@
+// -*- mode: c++ -*-
+////
+// Orbit determination throughput on synthetic tracks.
+//
+//  usage: bench-determination [objects [observations-per-track [threads]]]
+//
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <span>
+#include <vector>
+#include "determination.hpp"
+#include "orbit.hpp"
+#include "parallel.hpp"
+#include "propagator.hpp"
+
+using namespace orbit;
+
+int main(int argc, char *argv[])
+{
+    auto objects = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000ul;
+    auto perTrack = argc > 2 ? std::atoi(argv[2]) : 30;
+    auto threads = argc > 3 ? static_cast<unsigned>(std::atoi(argv[3])) : 0u;
+
+    // Ten minute passes of LEO to GEO orbits with 10 m tracking noise.
+    std::mt19937 generator{42};
+    std::uniform_real_distribution<double> uniform{0.0, 1.0};
+    std::normal_distribution<double> noise{0.0, 10.0};
+    KeplerPropagator<double> propagator;
+    std::vector<std::vector<PositionObservation<double>>> observations(objects);
+    for (auto &track: observations) {
+        KeplerianElements<double> elements{6.8e6 + 3.5e7*uniform(generator), 0.3*uniform(generator),
+                                           3.0*uniform(generator), 6.2*uniform(generator), 6.2*uniform(generator),
+                                           6.2*uniform(generator)};
+        StateVector<double> state{elements};
+        for (auto k = 0; k < perTrack; ++k) {
+            auto t = 600.0*k/(perTrack - 1);
+            auto position = propagator.propagate(state, t).r;
+            for (auto i = 0; i < 3; ++i) position[i] += noise(generator);
+            track.push_back({t, position, 10.0});
+        }
+    }
+    std::vector<std::span<const PositionObservation<double>>> tracks{observations.begin(), observations.end()};
+    std::vector<FitResult<double>> results(objects);
+
+    auto start = std::chrono::steady_clock::now();
+    determineOrbits<double>(tracks, results, muEarth, threads);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    auto converged = 0ul;
+    auto iterations = 0ul;
+    for (const auto &result: results) {
+        converged += result.converged ? 1 : 0;
+        iterations += result.iterations;
+    }
+    std::cout << "objects " << objects << ", observations/track " << perTrack
+              << ", threads " << numutil::workerCount(objects, threads) << "\n"
+              << "fits/second " << objects/elapsed.count() << "\n"
+              << "converged " << converged << "/" << objects
+              << ", mean iterations " << static_cast<double>(iterations)/objects << std::endl;
+    return 0;
+}
@@ -0,0 +1,114 @@
+// -*- mode: c++ -*-
+////
+// Shadow entry and exit detection over a catalog: analytic bracketing with root refinement against dense sampling
+// of the shadow function, for speed and for agreement of the event times.
+//
+//  usage: bench-eclipse [objects [days [sample-step [threads]]]]
+//
+// Dense sampling runs over the first 1% of the catalog (at least ten objects) and is scaled up to the full catalog.
+//
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <numbers>
+#include <vector>
+#include "eclipse.hpp"
+#include "parallel.hpp"
+#include "random.hpp"
+
+using namespace orbit;
+
+namespace {
+    /// Events found by checking the shadow state every step seconds, stamped at the first sample past each change.
+    auto sample(const SecularJ2Propagator<double> &orbit, const EphemerisCache<double> &ephemeris, double start,
+                double end, double step) -> std::vector<ShadowEvent>
+    {
+        auto state = [&](double t) {
+            auto nu = shadowFunction(orbit.position(t), ephemeris.sun(t));
+            return nu == 1.0 ? 0 : nu == 0.0 ? 2 : 1;
+        };
+        std::vector<ShadowEvent> events;
+        auto previous = state(start);
+        for (auto t = start + step; t <= end; t += step) {
+            auto current = state(t);
+            // A whole penumbra passage can fall between samples; report both crossings at this sample.
+            for (auto level = previous; level < current; ++level) {
+                events.push_back({t, 0, level == 0 ? ShadowEventType::penumbraEntry : ShadowEventType::umbraEntry});
+            }
+            for (auto level = previous; level > current; --level) {
+                events.push_back({t, 0, level == 2 ? ShadowEventType::umbraExit : ShadowEventType::penumbraExit});
+            }
+            previous = current;
+        }
+        return events;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    auto objects = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000ul;
+    auto days = argc > 2 ? std::atof(argv[2]) : 30.0;
+    auto step = argc > 3 ? std::atof(argv[3]) : 10.0;
+    auto threads = argc > 4 ? unsigned(std::atoi(argv[4])) : 0u;
+
+    const auto start = 9575.0*86400.0;
+    const auto end = start + days*86400.0;
+    EphemerisCache<double> ephemeris{start, end};
+    EclipseFinder<double> finder{ephemeris};
+
+    // LEO through GEO with some eccentric orbits, random planes.
+    numutil::Philox4x32 generator{7};
+    std::vector<SecularJ2Propagator<double>> catalog;
+    catalog.reserve(objects);
+    for (auto k = 0ul; k < objects; ++k) {
+        auto w = generator.words(k, 0);
+        auto u = numutil::Philox4x32::uniform(w[0]);
+        auto v = numutil::Philox4x32::uniform(w[1]);
+        auto a = 6.8e6 + 3.6e7*u*u;
+        auto e = k % 10 == 0 ? std::min(0.7, 0.9*(1.0 - 6.6e6/a)) : 0.01*v;
+        catalog.emplace_back(KeplerianElements<double>{a, e, std::numbers::pi*v, 6.3*u, 2.0*std::numbers::pi*v,
+                                                       6.0*u*v}, start);
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    auto lists = findEclipses<double>(finder, catalog, start, end, threads);
+    auto merged = mergeEvents(lists);
+    std::chrono::duration<double> analytic = std::chrono::steady_clock::now() - begin;
+
+    auto subset = std::min<std::size_t>(objects, std::max<std::size_t>(10, objects/100));
+    std::vector<std::vector<ShadowEvent>> dense(subset);
+    begin = std::chrono::steady_clock::now();
+    numutil::parallelFor(subset, [&](std::size_t first, std::size_t last, unsigned) {
+        for (auto k = first; k < last; ++k) dense[k] = sample(catalog[k], ephemeris, start, end, step);
+    }, threads);
+    std::chrono::duration<double> sampled = std::chrono::steady_clock::now() - begin;
+    auto denseEstimate = sampled.count()*double(objects)/double(subset);
+
+    // Sampled events should trail the refined ones by up to a step; anything else is a miss.
+    std::size_t matched = 0, mismatched = 0;
+    auto worst = 0.0;
+    for (auto k = 0u; k < subset; ++k) {
+        if (dense[k].size() != lists[k].size()) {
+            mismatched += std::max(dense[k].size(), lists[k].size());
+            continue;
+        }
+        for (auto j = 0u; j < dense[k].size(); ++j) {
+            auto lag = dense[k][j].time - lists[k][j].time;
+            if (dense[k][j].type != lists[k][j].type || lag < -0.01 || lag > step) ++mismatched;
+            else ++matched;
+            worst = std::max(worst, std::abs(lag));
+        }
+    }
+
+    std::cout << objects << " objects over " << days << " days, " << merged.size() << " events\n"
+              << "analytic brackets + refinement: " << analytic.count() << " s  ("
+              << 1.0e6*analytic.count()/objects << " us/object)\n"
+              << "dense sampling every " << step << " s:     " << denseEstimate << " s estimated from " << subset
+              << " objects  (" << 1.0e6*sampled.count()/subset << " us/object)\n"
+              << "speedup: " << denseEstimate/analytic.count() << "\n"
+              << "events matched within one step: " << matched << ", mismatched: " << mismatched
+              << ", largest lag " << worst << " s\n";
+    return 0;
+}
@@ -0,0 +1,147 @@
+// -*- mode: c++ -*-
+////
+// Per-measurement latency and bank throughput of the tracking filters.
+//
+//  usage: bench-filter [filters [updates-per-filter [threads]]]
+//
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <span>
+#include <string>
+#include <vector>
+#include "filter.hpp"
+#include "orbit.hpp"
+#include "parallel.hpp"
+#include "propagator.hpp"
+
+using namespace orbit;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+    const StateVector<double> truth{{1.2915326E+06, 8.4505435E+06, -2.033574E+06}, {-3289.3377, 2493.4338, -7662.0529}};
+
+    auto initialEstimate() -> FilterState<double>
+    {
+        FilterState<double> filter;
+        filter.state = truth;
+        for (auto i = 0; i < 3; ++i) {
+            filter.state.r[i] += 100.0;
+            filter.covariance[i][i] = 1.0e4;
+            filter.covariance[i + 3][i + 3] = 1.0e-2;
+        }
+        return filter;
+    }
+
+    /// Power of two nanosecond buckets: bucket k counts latencies in [2^k, 2^(k+1)) ns.
+    struct Histogram {
+        std::array<unsigned long, 40> buckets{};
+        unsigned long count = 0;
+
+        auto add(std::chrono::nanoseconds latency) -> void
+        {
+            auto ns = static_cast<unsigned long>(std::max<long>(1, latency.count()));
+            auto bucket = 0;
+            while (ns >>= 1) ++bucket;
+            ++buckets[bucket];
+            ++count;
+        }
+
+        /// Upper edge of the bucket holding the given fraction of samples.
+        auto percentile(double fraction) const -> unsigned long
+        {
+            auto target = static_cast<unsigned long>(fraction*count);
+            unsigned long seen = 0;
+            for (auto k = 0u; k < buckets.size(); ++k) {
+                seen += buckets[k];
+                if (seen > target) return 1ul << (k + 1);
+            }
+            return 1ul << buckets.size();
+        }
+
+        auto print(const std::string &name) const -> void
+        {
+            std::cout << std::left << std::setw(28) << name << std::right
+                      << " p50 <" << std::setw(7) << percentile(0.5) << " ns"
+                      << "  p99 <" << std::setw(7) << percentile(0.99) << " ns"
+                      << "  p99.9 <" << std::setw(7) << percentile(0.999) << " ns\n";
+        }
+    };
+
+    template<typename Filter, typename MakeMeasurement>
+    auto latency(const std::string &name, const Filter &kalman, MakeMeasurement make, int updates) -> void
+    {
+        KeplerPropagator<double> propagator;
+        auto filter = initialEstimate();
+        Histogram histogram;
+        for (auto k = 1; k <= updates; ++k) {
+            auto t = 10.0*k;
+            auto measurement = make(t, propagator.propagate(truth, t));
+            auto start = clock_type::now();
+            kalman.update(filter, measurement);
+            histogram.add(clock_type::now() - start);
+        }
+        histogram.print(name);
+    }
+
+    template<typename Filter>
+    auto throughput(const std::string &name, const Filter &kalman, std::size_t filters, int updates,
+                    unsigned threads) -> void
+    {
+        KeplerPropagator<double> propagator;
+        std::vector<FilterState<double>> states(filters, initialEstimate());
+        std::vector<PositionMeasurement<double>> measurements(filters);
+        std::chrono::duration<double> elapsed{0};
+        for (auto k = 1; k <= updates; ++k) {
+            auto t = 10.0*k;
+            auto position = propagator.propagate(truth, t).r;
+            for (auto &measurement: measurements) measurement = {t, position, 10.0};
+            auto start = clock_type::now();
+            updateFilters(kalman, std::span(states), std::span<const PositionMeasurement<double>>(measurements), {},
+                          threads);
+            elapsed += clock_type::now() - start;
+        }
+        std::cout << std::left << std::setw(28) << name << std::right << " "
+                  << static_cast<double>(filters)*updates/elapsed.count() << " updates/second\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    auto filters = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000ul;
+    auto updates = argc > 2 ? std::atoi(argv[2]) : 20;
+    auto threads = argc > 3 ? static_cast<unsigned>(std::atoi(argv[3])) : 0u;
+
+    ExtendedKalmanFilter<double> ekf{KeplerPropagator<double>{}, 1.0e-9};
+    UnscentedKalmanFilter<double> ukf{KeplerPropagator<double>{}, 1.0e-9};
+    ExtendedKalmanFilter<double, J2Propagator<double>> ekfJ2{J2Propagator<double>{}, 1.0e-9};
+
+    numutil::Vector3<double> station{6.4e6, 0.0, 0.0};
+    auto position = [](double t, const StateVector<double> &s) { return PositionMeasurement<double>{t, s.r, 10.0}; };
+    auto range = [&station](double t, const StateVector<double> &s) {
+        return RangeMeasurement<double>{t, station, (s.r - station).norm(), 10.0};
+    };
+    auto rangeRate = [&station](double t, const StateVector<double> &s) {
+        RangeRateMeasurement<double> measurement{t, station, {}, 0.0, 0.01};
+        measurement.rangeRate = measurement.predict(s)[0];
+        return measurement;
+    };
+
+    auto samples = 10000;
+    std::cout << "latency per update, " << samples << " sequential updates\n";
+    latency("ekf two-body position", ekf, position, samples);
+    latency("ekf two-body range", ekf, range, samples);
+    latency("ekf two-body range-rate", ekf, rangeRate, samples);
+    latency("ukf two-body position", ukf, position, samples);
+    latency("ekf j2 position", ekfJ2, position, samples);
+
+    std::cout << "\nthroughput, " << filters << " filters x " << updates << " updates, "
+              << numutil::workerCount(filters, threads, 64) << " threads\n";
+    throughput("ekf two-body position", ekf, filters, updates, threads);
+    throughput("ukf two-body position", ukf, filters, updates, threads);
+    throughput("ekf j2 position", ekfJ2, filters, updates, threads);
+    return 0;
+}
@@ -0,0 +1,58 @@
+// -*- mode: c++ -*-
+////
+// Spherical harmonic accelerations per second against degree and order.
+//
+//  usage: bench-gravity [coefficient-file [max-degree]]
+//
+// Without a file the field is filled with Kaula rule random coefficients, which cost the same to evaluate.
+//
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "constants.hpp"
+#include "gravity.hpp"
+
+using namespace orbit;
+
+int main(int argc, char *argv[])
+{
+    auto maxDegree = argc > 2 ? std::atoi(argv[2]) : 120;
+    auto field = argc > 1 ? GravityField<double>::load(argv[1], maxDegree)
+                          : GravityField<double>{maxDegree, muEarthEGM, earthRadiusEGM};
+    if (argc <= 1) {
+        std::mt19937 generator{1};
+        std::normal_distribution<double> gaussian{0.0, 1.0};
+        for (auto n = 2; n <= maxDegree; ++n) {
+            for (auto m = 0; m <= n; ++m) field.setCoefficients(n, m, 1.0e-5*gaussian(generator)/(n*n),
+                                                                 m > 0 ? 1.0e-5*gaussian(generator)/(n*n) : 0.0);
+        }
+    }
+
+    // Positions scattered over a 7000 km shell.
+    std::mt19937 generator{2};
+    std::normal_distribution<double> gaussian{0.0, 1.0};
+    std::vector<numutil::Vector3<double>> positions(4096);
+    for (auto &r: positions) {
+        r = {gaussian(generator), gaussian(generator), gaussian(generator)};
+        r = r.unit()*7.0e6;
+    }
+
+    GravityWorkspace<double> workspace{maxDegree};
+    std::cout << "degree  accelerations/second  ns/acceleration\n";
+    for (auto degree: {2, 4, 8, 12, 20, 30, 40, 50, 70, 90, 120, 180, 250, 360}) {
+        if (degree > field.degree()) break;
+        auto calls = std::max(4096l, 40000000l/((degree + 1)*(degree + 1)));
+        double checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (auto k = 0l; k < calls; ++k) checksum += field.acceleration(positions[k % positions.size()], workspace,
+                                                                        degree)[2];
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << std::setw(6) << degree << std::setw(22) << calls/elapsed.count()
+                  << std::setw(17) << 1.0e9*elapsed.count()/calls << (checksum == 0.0 ? " !" : "") << "\n";
+    }
+    return 0;
+}
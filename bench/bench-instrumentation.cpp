@@ -0,0 +1,49 @@
+// -*- mode: c++ -*-
+////
+// Cost of the instrumentation probes.  Build once with and once without -DORBIT_INSTRUMENTATION=ON and compare the
+// rates; with the probes on, the collected metrics are printed in the requested format.
+//
+//  usage: bench-instrumentation [calls [json|prometheus]]
+//
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "instrumentation.hpp"
+#include "orbit.hpp"
+#include "propagator.hpp"
+
+using namespace orbit;
+
+int main(int argc, char *argv[])
+{
+    auto calls = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000ul;
+    std::string format = argc > 2 ? argv[2] : "prometheus";
+
+    KeplerPropagator<double> propagator;
+    KeplerianElements<double> elements{26.61027E6, 0.74, 1.1, 4.4413224, 2.3, 1.0471976};
+    StateVector<double> state{elements};
+
+    double checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto k = 0ul; k < calls; ++k) checksum += propagator.propagate(state, 10.0*static_cast<double>(k % 1000)).r[0];
+    std::chrono::duration<double> propagation = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (auto k = 0ul; k < calls; ++k) {
+        elements.trueAnomaly = 1.0e-6*static_cast<double>(k);
+        checksum += StateVector<double>{elements}.v[1];
+    }
+    std::chrono::duration<double> conversion = std::chrono::steady_clock::now() - start;
+
+    std::cout << "instrumentation " << (instrumentation::enabled() ? "on" : "off") << "\n"
+              << "kepler propagations/second " << calls/propagation.count() << "\n"
+              << "element conversions/second " << calls/conversion.count() << "\n"
+              << "checksum " << checksum << "\n";
+    if (instrumentation::enabled()) {
+        auto snapshot = instrumentation::snapshot();
+        std::cout << (format == "json" ? instrumentation::toJson(snapshot) : instrumentation::toPrometheus(snapshot))
+                  << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+// -*- mode: c++ -*-
+////
+// Cost per simulated year of long arc J2 propagation: symplectic splitting against Cowell's method (fixed step
+// fourth order Runge-Kutta), with position error and energy drift after the arc.
+//
+//  usage: bench-longarc [days]
+//
+// The reference for each orbit is Cowell with a step of a five thousandth of the period, shortened by (1 - e)^(3/2)
+// for eccentric orbits.
+//
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numbers>
+#include <string>
+#include "constants.hpp"
+#include "longarc.hpp"
+#include "propagator.hpp"
+
+using namespace orbit;
+
+namespace {
+    const auto radius = earthEquatorialRadius*1.0e3;
+    const auto year = 365.25*86400.0;
+
+    auto energy(const StateVector<double> &state) -> double
+    {
+        auto r = state.r.norm();
+        auto sinLatitude = state.r[2]/r;
+        return state.v.dot(state.v)/2.0 - muEarth/r
+               + muEarth*earthJ2*radius*radius/(2.0*r*r*r)*(3.0*sinLatitude*sinLatitude - 1.0);
+    }
+
+    template<typename Propagator>
+    auto run(const std::string &label, const Propagator &propagator, const StateVector<double> &state, double span,
+             const StateVector<double> &reference) -> void
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto result = propagator.propagate(state, span);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "  " << std::left << std::setw(22) << label << std::right
+                  << std::setw(14) << elapsed.count()*year/span
+                  << std::setw(16) << (result.r - reference.r).norm()
+                  << std::setw(16) << std::abs(energy(result)/energy(state) - 1.0) << "\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    auto days = argc > 1 ? std::atof(argv[1]) : 30.0;
+    auto span = days*86400.0;
+
+    struct Case {
+        const char *name;
+        KeplerianElements<double> elements;
+    };
+    const Case cases[] = {{"LEO 700 km", {7078.0e3, 0.001, 1.7, 0.3, 0.2, 0.1}},
+                          {"GPS", {26560.0e3, 0.01, 0.96, 2.0, 4.0, 0.5}},
+                          {"Molniya", {26560.0e3, 0.72, 1.1, 2.0, 4.7, 0.5}},
+                          {"GEO", {42164.0e3, 0.0005, 0.001, 0.0, 0.0, 0.0}}};
+
+    std::cout << std::setprecision(4) << "arc " << days << " days\n"
+              << "  method                 s/sim-year  position error  energy drift\n";
+    for (const auto &c: cases) {
+        StateVector<double> state{c.elements};
+        auto period = 2.0*std::numbers::pi*std::sqrt(std::pow(c.elements.semiMajorAxis, 3)/muEarth);
+        auto periapsisScale = period*std::pow(1.0 - c.elements.eccentricity, 1.5);
+        auto reference = J2Propagator<double>{muEarth, earthJ2, radius, periapsisScale/5000.0}.propagate(state, span);
+
+        std::cout << c.name << "\n";
+        for (auto divisions: {100.0, 300.0, 1000.0}) {
+            run("Cowell T/" + std::to_string(int(divisions)),
+                J2Propagator<double>{muEarth, earthJ2, radius, period/divisions}, state, span, reference);
+        }
+        for (auto steps: {16, 32, 64}) {
+            run("symplectic " + std::to_string(steps) + "/rev",
+                SymplecticPropagator<double>{muEarth, earthJ2, radius, steps}, state, span, reference);
+        }
+    }
+    return 0;
+}
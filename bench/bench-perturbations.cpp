@@ -0,0 +1,75 @@
+// -*- mode: c++ -*-
+////
+// Luni-solar force evaluations per second with analytic Sun and Moon positions computed in every call against
+// positions interpolated from one EphemerisCache shared by all threads.
+//
+//  usage: bench-perturbations [objects [threads]]
+//
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "constants.hpp"
+#include "ephemeris.hpp"
+#include "parallel.hpp"
+#include "perturbations.hpp"
+
+using namespace orbit;
+using vector3 = numutil::Vector3<double>;
+
+namespace {
+    const auto start = 86400.0*9000.0;
+    const auto span = 86400.0;
+    const auto steps = 96;
+
+    template<typename Force>
+    auto run(const char *label, std::size_t objects, unsigned threads, Force force) -> double
+    {
+        std::vector<vector3> positions(objects);
+        for (auto k = 0u; k < objects; ++k) {
+            auto angle = 0.001*k;
+            positions[k] = {4.2e7*std::cos(angle), 4.2e7*std::sin(angle), 1.0e6*std::sin(3.0*angle)};
+        }
+        std::vector<double> checksum(numutil::workerCount(objects, threads), 0.0);
+        auto begin = std::chrono::steady_clock::now();
+        numutil::parallelFor(objects, [&](std::size_t first, std::size_t last, unsigned worker) {
+            for (auto k = first; k < last; ++k) {
+                for (auto step = 0; step < steps; ++step) {
+                    checksum[worker] += force(start + step*span/steps, positions[k])[0];
+                }
+            }
+        }, threads);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        auto rate = double(objects)*steps/elapsed.count();
+        auto total = 0.0;
+        for (auto c: checksum) total += c;
+        std::cout << label << rate << " evaluations/s  " << 1.0e9/rate << " ns each" << (total == 0.0 ? " !" : "")
+                  << "\n";
+        return rate;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    auto objects = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000ul;
+    auto threads = argc > 2 ? unsigned(std::atoi(argv[2])) : 0u;
+
+    auto direct = run("analytic ephemeris per call: ", objects, threads, [](double t, const vector3 &r) {
+        auto sun = sunPosition<double>(t);
+        return thirdBodyAcceleration(r, sun, muSun) + thirdBodyAcceleration(r, moonPosition<double>(t), muMoon)
+               + solarRadiationPressure(r, sun, 0.02, 1.3);
+    });
+
+    auto built = std::chrono::steady_clock::now();
+    EphemerisCache<double> cache{start, start + span};
+    std::chrono::duration<double> buildTime = std::chrono::steady_clock::now() - built;
+    std::cout << "cache build: " << 1.0e6*buildTime.count() << " us\n";
+
+    LuniSolarForce<double> force{cache, 0.02, 1.3};
+    auto cached = run("shared ephemeris cache:      ", objects, threads, [&](double t, const vector3 &r) {
+        return force.acceleration(t, r);
+    });
+    std::cout << "speedup: " << cached/direct << "\n";
+    return 0;
+}
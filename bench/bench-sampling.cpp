@@ -0,0 +1,79 @@
+// -*- mode: c++ -*-
+////
+// Throughput and memory of element grid and Monte Carlo sampling with a parallel reduction.
+//
+//  usage: bench-sampling [samples [threads]]
+//
+#include <sys/resource.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include "orbit.hpp"
+#include "parallel.hpp"
+#include "sampling.hpp"
+
+using namespace orbit;
+
+namespace {
+    /// Perigee altitude histogram in 100 km bins plus the extreme radius reached.
+    struct Coverage {
+        std::array<std::uint64_t, 400> perigee{};
+        double maxRadius = 0.0;
+    };
+
+    auto peakResidentKilobytes() -> long
+    {
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+    }
+
+    template<typename Sampler>
+    auto run(const char *name, const Sampler &sampler, unsigned threads) -> void
+    {
+        auto accumulate = [](Coverage &c, const KeplerianElements<double> &e, const StateVector<double> &s) {
+            auto altitude = e.semiMajorAxis*(1.0 - e.eccentricity) - earthEquatorialRadius*1.0e3;
+            auto bin = std::clamp(static_cast<long>(altitude/1.0e5), 0l, static_cast<long>(c.perigee.size()) - 1);
+            ++c.perigee[bin];
+            c.maxRadius = std::max(c.maxRadius, s.r.norm());
+        };
+        auto merge = [](Coverage &into, const Coverage &from) {
+            for (auto k = 0u; k < into.perigee.size(); ++k) into.perigee[k] += from.perigee[k];
+            into.maxRadius = std::max(into.maxRadius, from.maxRadius);
+        };
+
+        auto start = std::chrono::steady_clock::now();
+        auto result = sampleReduce(sampler, Coverage{}, accumulate, merge, threads);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::uint64_t total = 0;
+        for (auto count: result.perigee) total += count;
+        std::cout << name << ": " << sampler.size() << " samples in " << elapsed.count() << " s, "
+                  << sampler.size()/elapsed.count() << " samples/second, checksum " << total
+                  << ", max radius " << result.maxRadius << " m, peak RSS " << peakResidentKilobytes() << " kB\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    auto samples = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000000ull;
+    auto threads = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 0u;
+    std::cout << "threads " << numutil::workerCount(samples, threads) << ", baseline peak RSS "
+              << peakResidentKilobytes() << " kB\n";
+
+    // A grid with about the requested number of points: 10 values of each of a, e, i, node and periapsis and the
+    // rest in true anomaly.
+    auto anomalies = std::max<std::uint64_t>(1, samples/100000);
+    ElementGrid<double> grid{{GridAxis<double>{6.8e6, 4.2e7, 10}, {0.0, 0.7, 10}, {0.0, 3.1, 10},
+                              {0.0, 6.2, 10}, {0.0, 6.2, 10}, {0.0, 6.28, anomalies}}};
+    run("grid", grid, threads);
+
+    KeplerianElements<double> nominal{2.4e7, 0.7, 1.1, 1.0, 4.7, 0.0};
+    ElementDispersion<double> dispersion{nominal, {5.0e4, 0.01, 0.002, 0.01, 0.01, 3.14}, samples, 2026};
+    run("dispersion", dispersion, threads);
+    return 0;
+}
@@ -0,0 +1,140 @@
+// -*- mode: c++ -*-
+////
+// Geometric screening of a large mixed catalog (LEO, MEO, GEO and highly elliptical orbits) with the k-d tree
+// index against a linear scan of the same orbit geometries: altitude shell queries and proximity queries at a few
+// points.  Both sides return the same ids.
+//
+//  usage: bench-spatial [objects [queries]]
+//
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numbers>
+#include <vector>
+#include "bodies.hpp"
+#include "random.hpp"
+#include "spatial.hpp"
+
+using namespace orbit;
+using vector3 = numutil::Vector3<double>;
+
+namespace {
+    auto randomElements(const numutil::Philox4x32 &generator, std::uint64_t counter) -> KeplerianElements<double>
+    {
+        auto w = generator.words(counter, 0);
+        auto u = numutil::Philox4x32::uniform(w[0]);
+        auto v = numutil::Philox4x32::uniform(w[1]);
+        auto x = numutil::Philox4x32::uniform(generator.words(counter, 1)[0]);
+        auto angles = [&](double a, double e, double i) -> KeplerianElements<double> {
+            return {a, e, i, 2*std::numbers::pi*u, 2*std::numbers::pi*v, 0.0};
+        };
+        switch (counter % 10) {
+            case 0:     // geosynchronous belt
+                return angles(4.2164e7 + 2.0e5*(x - 0.5), 0.001*v, 0.3*x);
+            case 1:     // navigation constellations
+                return angles(2.6e7 + 3.0e6*x, 0.01*v, 0.9 + 0.2*x);
+            case 2:     // Molniya and transfer orbits
+                return angles(2.5e7 + 1.5e7*x, 0.6 + 0.12*v, 0.5 + 0.7*x);
+            default:    // low earth orbit
+                return angles(Earth::radius + 3.0e5 + 1.2e6*x*x, 0.005*v, std::numbers::pi*x);
+        }
+    }
+
+    auto point(double radius, double u, double v) -> vector3
+    {
+        auto z = 2*u - 1;
+        auto phi = 2*std::numbers::pi*v;
+        return {radius*std::sqrt(1 - z*z)*std::cos(phi), radius*std::sqrt(1 - z*z)*std::sin(phi), radius*z};
+    }
+
+    template<typename Function>
+    auto seconds(Function &&function) -> double
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    auto objects = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000ul;
+    auto queries = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    numutil::Philox4x32 generator{17};
+    std::vector<KeplerianElements<double>> catalog;
+    catalog.reserve(objects);
+    for (auto k = 0ul; k < objects; ++k) catalog.push_back(randomElements(generator, k));
+
+    std::vector<OrbitGeometry<double>> geometries;
+    auto scanBuild = seconds([&] {
+        geometries.reserve(objects);
+        for (const auto &elements: catalog) geometries.emplace_back(elements);
+    });
+    auto indexBuild = seconds([&] { OrbitIndex<double>{catalog}.size(); });
+    OrbitIndex<double> index{catalog};
+
+    std::cout << std::setprecision(4) << objects << " orbits\n"
+              << "geometry only:  " << scanBuild << " s\n"
+              << "index build:    " << indexBuild << " s\n\n"
+              << std::left << std::setw(30) << "query" << std::setw(12) << "scan s" << std::setw(12) << "index s"
+              << std::setw(10) << "speedup" << std::setw(10) << "matches" << std::setw(12) << "visited %"
+              << "agree\n";
+
+    auto report = [&](const char *name, double scan, double indexed, std::size_t matches, std::size_t visited,
+                      bool agree) {
+        std::cout << std::setw(30) << name << std::setw(12) << scan << std::setw(12) << indexed << std::setw(10)
+                  << scan/indexed << std::setw(10) << matches << std::setw(12) << 100.0*double(visited)/double(objects)
+                  << (agree ? "yes" : "NO") << "\n";
+    };
+
+    const struct { const char *name; double inner, outer; } shells[] = {
+            {"shell 500-600 km", Earth::radius + 5.0e5, Earth::radius + 6.0e5},
+            {"shell GEO +-50 km", 4.2164e7 - 5.0e4, 4.2164e7 + 5.0e4},
+            {"shell 10000-12000 km", Earth::radius + 1.0e7, Earth::radius + 1.2e7}};
+    for (const auto &shell: shells) {
+        std::vector<std::size_t> expected, found;
+        auto scan = seconds([&] {
+            for (auto q = 0; q < queries; ++q) {
+                expected.clear();
+                for (std::size_t k = 0; k < geometries.size(); ++k) {
+                    if (geometries[k].perigeeRadius() <= shell.outer && geometries[k].apogeeRadius() >= shell.inner) {
+                        expected.push_back(k);
+                    }
+                }
+            }
+        });
+        auto indexed = seconds([&] { for (auto q = 0; q < queries; ++q) found = index.shell(shell.inner, shell.outer); });
+        report(shell.name, scan, indexed, found.size(), OrbitIndex<double>::lastVisited().first, found == expected);
+    }
+
+    // Proximity is costly per orbit on the scan side, so it sees fewer points.
+    const struct { const char *name; double radius, distance; } spheres[] = {
+            {"near 800 km alt, 10 km", Earth::radius + 8.0e5, 1.0e4},
+            {"near GEO, 10 km", 4.2164e7, 1.0e4},
+            {"near 20000 km alt, 100 km", Earth::radius + 2.0e7, 1.0e5}};
+    auto points = std::max(1, queries/10);
+    for (const auto &sphere: spheres) {
+        std::size_t matches = 0, visited = 0;
+        bool agree = true;
+        double scan = 0, indexed = 0;
+        for (auto q = 0; q < points; ++q) {
+            auto w = generator.words(q, 7);
+            auto at = point(sphere.radius, numutil::Philox4x32::uniform(w[0]), numutil::Philox4x32::uniform(w[1]));
+            std::vector<std::size_t> expected, found;
+            scan += seconds([&] {
+                for (std::size_t k = 0; k < geometries.size(); ++k) {
+                    if (geometries[k].distanceTo(at) <= sphere.distance) expected.push_back(k);
+                }
+            });
+            indexed += seconds([&] { found = index.near(at, sphere.distance); });
+            matches += found.size();
+            visited += OrbitIndex<double>::lastVisited().first;
+            agree = agree && found == expected;
+        }
+        report(sphere.name, scan, indexed, matches, visited/points, agree);
+    }
+    return 0;
+}
@@ -0,0 +1,469 @@
+// -*- mode: c++ -*-
+////
+// Asynchronous batch front end for callers running on an event loop: batches of conversions or propagations are
+// split into chunks on an internal worker pool, and the caller gets a handle it can co_await from a C++20 coroutine,
+// attach a completion callback to, or wait on.  Submitting never runs the work on the caller's thread and never
+// waits: work in flight is bounded, and a batch submitted beyond the bound is parked and started as earlier batches
+// finish.  A batch can be cancelled through its handle or a std::stop_token.
+//
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
+
+#ifndef ORBIT_ASYNC_HPP
+#define ORBIT_ASYNC_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "orbit.hpp"
+#include "parallel.hpp"
+
+namespace numutil {
+    /// Thrown by BatchResult::get, and by co_await on it, when the batch was cancelled before it finished.
+    class OperationCancelled : public std::runtime_error {
+    public:
+        OperationCancelled() : std::runtime_error{"batch cancelled"} {}
+    };
+
+    enum class BatchStatus {pending, done, failed, cancelled};
+
+    /// Shared state of one batch: results, cancellation and the continuations to run when the last chunk finishes.
+    template<typename T>
+    class BatchState {
+    public:
+        // KeplerianElements has neither a default constructor nor assignment; hold such results in optionals.
+        using slotType = std::conditional_t<std::is_default_constructible_v<T> && std::is_move_assignable_v<T>, T,
+                                            std::optional<T>>;
+
+        BatchState(std::size_t count, std::size_t chunks, std::stop_token external0)
+                : results(count), remaining{chunks}, external{std::move(external0)} {}
+
+        auto stopRequested() const -> bool { return stopSource.stop_requested() || external.stop_requested(); }
+
+        auto store(std::size_t k, T &&value) -> void
+        {
+            if constexpr (std::is_same_v<slotType, T>) results[k] = std::move(value);
+            else results[k].emplace(std::move(value));
+        }
+
+        /// Register a continuation; false, without registering, if the batch has already finished.
+        auto addContinuation(std::function<void()> continuation) -> bool
+        {
+            std::lock_guard lock{mutex};
+            if (status != BatchStatus::pending) return false;
+            continuations.push_back(std::move(continuation));
+            return true;
+        }
+
+        /// Called by each chunk as it finishes; true for the last one, which must then call complete().
+        auto chunkDone() -> bool { return remaining.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+        auto complete() -> void
+        {
+            std::vector<std::function<void()>> ready;
+            {
+                std::lock_guard lock{mutex};
+                status = failure ? BatchStatus::failed : skipped ? BatchStatus::cancelled : BatchStatus::done;
+                ready.swap(continuations);
+            }
+            finished.notify_all();
+            for (auto &continuation: ready) continuation();
+        }
+
+        /// Call onStop if a stop is requested, through the handle or the caller's token, while the watch is armed;
+        /// at once if one already has been.  Watching ends with the state.
+        auto watchStop(const std::function<void()> &onStop) -> void
+        {
+            internalWatch.emplace(stopSource.get_token(), onStop);
+            externalWatch.emplace(external, onStop);
+        }
+
+        auto fail(std::exception_ptr error) -> void
+        {
+            {
+                std::lock_guard lock{mutex};
+                if (!failure) failure = std::move(error);
+            }
+            stopSource.request_stop();
+        }
+
+        auto wait() -> BatchStatus
+        {
+            std::unique_lock lock{mutex};
+            finished.wait(lock, [this] { return status != BatchStatus::pending; });
+            return status;
+        }
+
+        auto currentStatus() -> BatchStatus
+        {
+            std::lock_guard lock{mutex};
+            return status;
+        }
+
+        /// Move the results out, or throw the batch's failure.
+        auto take() -> std::vector<T>
+        {
+            auto outcome = wait();
+            if (outcome == BatchStatus::failed) std::rethrow_exception(failure);
+            if (outcome == BatchStatus::cancelled) throw OperationCancelled{};
+            if constexpr (std::is_same_v<slotType, T>) {
+                return std::move(results);
+            } else {
+                std::vector<T> values;
+                values.reserve(results.size());
+                for (auto &slot: results) values.push_back(std::move(*slot));
+                return values;
+            }
+        }
+
+        std::vector<slotType> results;
+        std::stop_source stopSource;
+        std::atomic<bool> skipped{false};
+
+    private:
+        std::atomic<std::size_t> remaining;
+        std::stop_token external;
+        std::mutex mutex;
+        std::condition_variable finished;
+        BatchStatus status = BatchStatus::pending;
+        std::exception_ptr failure;
+        std::vector<std::function<void()>> continuations;
+        std::optional<std::stop_callback<std::function<void()>>> internalWatch;
+        std::optional<std::stop_callback<std::function<void()>>> externalWatch;
+    };
+
+
+    /**
+     * Handle to a submitted batch, like a std::future: the results are moved out by get() or co_await, once.
+     * A coroutine awaiting the batch resumes on the pool thread that finished it; post back to the event loop from
+     * there, or use onComplete, if the loop needs the continuation on its own thread.
+     * @tparam T Result type of each item.
+     */
+    template<typename T>
+    class BatchResult {
+    public:
+        explicit BatchResult(std::shared_ptr<BatchState<T>> state0) : state{std::move(state0)} {}
+
+        auto ready() const -> bool { return state->currentStatus() != BatchStatus::pending; }
+
+        auto status() const -> BatchStatus { return state->currentStatus(); }
+
+        /// Skip the chunks not yet started; the batch then finishes as cancelled.  A batch still parked by the
+        /// executor leaves its admission queue and finishes as cancelled at once, on the cancelling thread.
+        auto cancel() -> void { state->stopSource.request_stop(); }
+
+        /// Block until the batch finishes.  For threads that may block; event loops use co_await or onComplete.
+        auto wait() const -> BatchStatus { return state->wait(); }
+
+        /// Results in submission order; throws OperationCancelled, or the first exception thrown by the work.
+        auto get() -> std::vector<T> { return state->take(); }
+
+        /// Call continuation once the batch finishes: on the finishing pool thread, or at once if already finished.
+        auto onComplete(std::function<void()> continuation) -> void
+        {
+            if (!state->addContinuation(continuation)) continuation();
+        }
+
+        auto operator co_await() const
+        {
+            struct Awaiter {
+                std::shared_ptr<BatchState<T>> state;
+
+                auto await_ready() const -> bool { return state->currentStatus() != BatchStatus::pending; }
+
+                auto await_suspend(std::coroutine_handle<> handle) -> bool
+                {
+                    return state->addContinuation([handle] { handle.resume(); });
+                }
+
+                auto await_resume() -> std::vector<T> { return state->take(); }
+            };
+            return Awaiter{state};
+        }
+
+    private:
+        std::shared_ptr<BatchState<T>> state;
+    };
+
+
+    /**
+     * Fixed pool of workers running batches of independent items, at most capacity() items in flight.  Batches that
+     * do not fit wait, in submission order, in an admission queue drained by the pool as room frees, so neither an
+     * event loop thread nor a continuation submitting from a pool thread ever blocks.  The admission queue has no
+     * bound of its own: map always accepts, so a caller able to submit faster than the pool drains should use tryMap,
+     * or watch waiting(), to push back.  A parked batch that is cancelled leaves the queue at once without taking any
+     * room.  Destruction finishes the work already submitted, parked batches included, so continuations of every
+     * submitted batch run.
+     */
+    class AsyncExecutor {
+    public:
+        /**
+         * @param workers Number of pool threads, 0 for one per hardware thread.
+         * @param maxInFlight Items started and not yet finished beyond which map parks a batch, or tryMap declines.
+         *        A single batch larger than this is admitted when nothing else is in flight.
+         * @param grain Items per chunk, the unit of scheduling and of cancellation.
+         */
+        explicit AsyncExecutor(unsigned workers = 0, std::size_t maxInFlight = std::size_t{1} << 20,
+                               std::size_t grain = 1024)
+                : capacityLimit{std::max<std::size_t>(1, maxInFlight)}, grainSize{std::max<std::size_t>(1, grain)}
+        {
+            auto n = workers == 0 ? defaultConcurrency() : workers;
+            threads.reserve(n);
+            for (auto k = 0u; k < n; ++k) threads.emplace_back([this] { run(); });
+        }
+
+        AsyncExecutor(const AsyncExecutor &) = delete;
+        auto operator=(const AsyncExecutor &) -> AsyncExecutor & = delete;
+
+        ~AsyncExecutor()
+        {
+            {
+                std::lock_guard lock{mutex};
+                stopping = true;
+            }
+            workAvailable.notify_all();
+            threads.clear();
+        }
+
+        auto workers() const -> unsigned { return static_cast<unsigned>(threads.size()); }
+
+        auto capacity() const -> std::size_t { return capacityLimit; }
+
+        auto inFlight() const -> std::size_t
+        {
+            std::lock_guard lock{mutex};
+            return inFlightCount;
+        }
+
+        /// Batches submitted by map and parked until there is room for them.
+        auto waiting() const -> std::size_t
+        {
+            std::lock_guard lock{mutex};
+            return admissions.size();
+        }
+
+        /**
+         * Submit function applied to each input and return at once.  The batch starts now if capacity() allows, and
+         * otherwise once the batches ahead of it leave room; its result is pending until then.
+         * Inputs and function are moved into the batch, so nothing the caller holds needs to outlive it.
+         * @param cancel Optional token whose stop request cancels the batch like BatchResult::cancel.
+         */
+        template<typename Input, typename Function>
+        auto map(std::vector<Input> inputs, Function function, std::stop_token cancel = {})
+                -> BatchResult<std::invoke_result_t<Function &, const Input &>>
+        {
+            return *launch(std::move(inputs), std::move(function), std::move(cancel), true);
+        }
+
+        /// As map, but returns nothing instead of parking the batch when there is no room.
+        template<typename Input, typename Function>
+        auto tryMap(std::vector<Input> inputs, Function function, std::stop_token cancel = {})
+                -> std::optional<BatchResult<std::invoke_result_t<Function &, const Input &>>>
+        {
+            return launch(std::move(inputs), std::move(function), std::move(cancel), false);
+        }
+
+    private:
+        /// A batch waiting for room: its size, the call that queues its chunks, made with the mutex held, and a flag
+        /// set by whichever of release and a stop request takes the batch out of the queue first.
+        struct Admission {
+            std::size_t count;
+            std::function<void()> start;
+            std::shared_ptr<std::atomic<bool>> claimed;
+        };
+
+        auto fits(std::size_t count) const -> bool
+        {
+            return inFlightCount == 0 || inFlightCount + count <= capacityLimit;
+        }
+
+        /// Return the room of a finished batch and start the parked batches that now fit, oldest first.  Batches a
+        /// stop request has claimed are passed over and left for withdraw to remove.
+        auto release(std::size_t count) -> void
+        {
+            auto started = false;
+            {
+                std::lock_guard lock{mutex};
+                inFlightCount -= count;
+                for (auto next = admissions.begin(); next != admissions.end();) {
+                    if (next->claimed->load()) {
+                        ++next;
+                        continue;
+                    }
+                    if (!fits(next->count) || next->claimed->exchange(true)) break;
+                    inFlightCount += next->count;
+                    next->start();
+                    next = admissions.erase(next);
+                    started = true;
+                }
+            }
+            if (started) workAvailable.notify_all();
+        }
+
+        /// Remove a parked batch claimed by a stop request.  Nothing of the executor is touched after the unlock, so
+        /// a destructor waiting for the queue to empty may finish as soon as this returns.
+        auto withdraw(const std::shared_ptr<std::atomic<bool>> &claimed) -> void
+        {
+            std::optional<Admission> removed;
+            std::lock_guard lock{mutex};
+            auto found = std::find_if(admissions.begin(), admissions.end(), [&](const Admission &admission) {
+                return admission.claimed == claimed;
+            });
+            removed.emplace(std::move(*found));
+            admissions.erase(found);
+            workAvailable.notify_all();
+        }
+
+        template<typename Input, typename Function>
+        auto launch(std::vector<Input> inputs, Function function, std::stop_token cancel, bool park)
+                -> std::optional<BatchResult<std::invoke_result_t<Function &, const Input &>>>
+        {
+            using resultType = std::invoke_result_t<Function &, const Input &>;
+            auto count = inputs.size();
+            auto chunks = (count + grainSize - 1)/grainSize;
+            auto state = std::make_shared<BatchState<resultType>>(count, chunks, std::move(cancel));
+            if (count == 0) {
+                state->complete();
+                return BatchResult<resultType>{state};
+            }
+
+            auto shared = std::make_shared<std::pair<std::vector<Input>, Function>>(std::move(inputs),
+                                                                                      std::move(function));
+            auto start = [this, state, shared, count] {
+                for (std::size_t begin = 0; begin < count; begin += grainSize) {
+                    auto end = std::min(begin + grainSize, count);
+                    queue.emplace_back([this, state, shared, begin, end, count] {
+                        if (state->stopRequested()) {
+                            state->skipped = true;
+                        } else {
+                            try {
+                                for (auto k = begin; k < end; ++k) state->store(k, shared->second(shared->first[k]));
+                            } catch (...) {
+                                state->fail(std::current_exception());
+                            }
+                        }
+                        if (state->chunkDone()) {
+                            // Free the room first so follow on work submitted by continuations can start at once.
+                            release(count);
+                            state->complete();
+                        }
+                    });
+                }
+            };
+            auto claimed = std::make_shared<std::atomic<bool>>(false);
+            auto parked = false;
+            {
+                std::lock_guard lock{mutex};
+                // Parked batches go first, so a stream of small batches cannot starve a large one.
+                if (admissions.empty() && fits(count)) {
+                    inFlightCount += count;
+                    start();
+                } else if (park) {
+                    admissions.push_back({count, std::move(start), claimed});
+                    parked = true;
+                } else {
+                    return std::nullopt;
+                }
+            }
+            if (!parked) {
+                workAvailable.notify_all();
+                return BatchResult<resultType>{state};
+            }
+
+            // Parked.  Armed outside the lock, since a stop already requested runs the callback here and now.  The
+            // claim keeps the batch in the queue, and so the executor alive, until withdraw has removed it.
+            std::weak_ptr<BatchState<resultType>> watched = state;
+            state->watchStop([this, watched, claimed] {
+                if (claimed->exchange(true)) return;
+                // The queued admission holds the state until withdraw, so the lock always succeeds.
+                auto batch = watched.lock();
+                withdraw(claimed);
+                if (!batch) return;
+                batch->skipped = true;
+                batch->complete();
+            });
+            return BatchResult<resultType>{state};
+        }
+
+        auto run() -> void
+        {
+            for (;;) {
+                std::function<void()> job;
+                {
+                    std::unique_lock lock{mutex};
+                    workAvailable.wait(lock, [this] { return !queue.empty() || (stopping && admissions.empty()); });
+                    if (queue.empty()) return;
+                    job = std::move(queue.front());
+                    queue.pop_front();
+                }
+                job();
+            }
+        }
+
+        std::size_t capacityLimit;
+        std::size_t grainSize;
+        mutable std::mutex mutex;
+        std::condition_variable workAvailable;
+        std::deque<std::function<void()>> queue;
+        std::deque<Admission> admissions;
+        std::size_t inFlightCount = 0;
+        bool stopping = false;
+        std::vector<std::jthread> threads;  // last, so the pool stops before the rest is destroyed
+    };
+}
+
+
+namespace orbit {
+    /// State vectors from elements, asynchronously.
+    template<typename ScalarType>
+    auto toStatesAsync(numutil::AsyncExecutor &executor, std::vector<KeplerianElements<ScalarType>> elements,
+                       std::stop_token cancel = {}) -> numutil::BatchResult<StateVector<ScalarType>>
+    {
+        return executor.map(std::move(elements), [](const KeplerianElements<ScalarType> &e) {
+            return StateVector<ScalarType>{e};
+        }, std::move(cancel));
+    }
+
+    /// Elements from state vectors about a body of gravitational constant mu, asynchronously.
+    template<typename ScalarType>
+    auto toElementsAsync(numutil::AsyncExecutor &executor, std::vector<StateVector<ScalarType>> states,
+                         ScalarType mu = orbit::muEarth, std::stop_token cancel = {})
+            -> numutil::BatchResult<KeplerianElements<ScalarType>>
+    {
+        return executor.map(std::move(states), [mu](const StateVector<ScalarType> &state) {
+            return KeplerianElements<ScalarType>{state, mu};
+        }, std::move(cancel));
+    }
+
+    /**
+     * Each state advanced by dt, asynchronously.  The propagator is copied into the batch.
+     * @tparam Propagator KeplerPropagator, J2Propagator, SymplecticPropagator or anything with propagate(state, dt).
+     */
+    template<typename Propagator, typename ScalarType>
+    auto propagateAsync(numutil::AsyncExecutor &executor, const Propagator &propagator,
+                        std::vector<StateVector<ScalarType>> states, ScalarType dt, std::stop_token cancel = {})
+            -> numutil::BatchResult<StateVector<ScalarType>>
+    {
+        return executor.map(std::move(states), [propagator, dt](const StateVector<ScalarType> &state) {
+            return propagator.propagate(state, dt);
+        }, std::move(cancel));
+    }
+}
+
+#endif //ORBIT_ASYNC_HPP
+#pragma clang diagnostic pop
@@ -0,0 +1,140 @@
+// -*- mode: c++ -*-
+////
+// Central body descriptors fixing the gravitational parameter, equatorial radius and low zonal harmonics at compile
+// time, and the conversion and propagation kernels specialized on them.  With the body a template parameter mu and
+// its reciprocals fold into constants, element sets drop the per-object mu KeplerianElements carries, and divisions
+// by mu in the kernels become multiplications.
+//
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
+
+#ifndef ORBIT_BODIES_HPP
+#define ORBIT_BODIES_HPP
+
+#include "constants.hpp"
+#include "orbit.hpp"
+#include "propagator.hpp"
+
+namespace numutil {
+    /// Square root in a constant expression, by Newton's iteration from above; x > 0.
+    constexpr auto constexprSqrt(double x) -> double
+    {
+        auto root = x > 1 ? x : 1.0;
+        for (auto next = (root + x/root)/2; next < root; next = (root + x/root)/2) root = next;
+        return root;
+    }
+}
+
+
+namespace orbit {
+    /// Earth, WGS 84 radius; J3 and J4 EGM96 unnormalized.
+    struct Earth {
+        static constexpr double mu = muEarth;                   // m^3/s^2
+        static constexpr double radius = earthEquatorialRadius*1.0e3;  // m, from km
+        static constexpr double j2 = earthJ2;
+        static constexpr double j3 = -2.53265649e-6;
+        static constexpr double j4 = -1.61962159e-6;
+    };
+
+    /// Moon, LP165P gravity field.
+    struct Moon {
+        static constexpr double mu = muMoon;                    // m^3/s^2
+        static constexpr double radius = moonRadius;            // m
+        static constexpr double j2 = 2.0321568e-4;
+        static constexpr double j3 = 8.4759e-6;
+        static constexpr double j4 = -9.5919e-6;
+    };
+
+    /// Mars, GMM-3 gravity field.
+    struct Mars {
+        static constexpr double mu = 4.282837e13;               // m^3/s^2
+        static constexpr double radius = 3.3962e6;              // m
+        static constexpr double j2 = 1.96045e-3;
+        static constexpr double j3 = 3.1450e-5;
+        static constexpr double j4 = -1.5377e-5;
+    };
+
+    /// Sun; only the helioseismic J2 is known well enough to use.
+    struct Sun {
+        static constexpr double mu = muSun;                     // m^3/s^2
+        static constexpr double radius = sunRadius;             // m, nominal
+        static constexpr double j2 = 2.2e-7;
+        static constexpr double j3 = 0.0;
+        static constexpr double j4 = 0.0;
+    };
+
+
+    /// Compile time counterpart of RuntimeGravity: the same members, as constants rounded once to ScalarType.
+    template<typename Body, typename ScalarType>
+    struct BodyGravity {
+        static constexpr ScalarType mu = ScalarType(Body::mu);
+        static constexpr ScalarType muInverse = ScalarType(1.0/Body::mu);
+        static constexpr ScalarType sqrtMu = ScalarType(numutil::constexprSqrt(Body::mu));
+        static constexpr ScalarType sqrtMuInverse = ScalarType(1.0/numutil::constexprSqrt(Body::mu));
+    };
+
+
+    /**
+     * Classical elements about a body fixed at compile time: KeplerianElements without the stored mu.
+     * @tparam Body Earth, Moon, Mars, Sun or any type with the same static members.
+     * @tparam ScalarType float or double.
+     */
+    template<typename Body, typename ScalarType>
+    struct BodyElements {
+        ScalarType semiMajorAxis;   // m
+        ScalarType eccentricity;
+        ScalarType inclination;     // radians
+        ScalarType rightAscensionAscendingNode; // radians
+        ScalarType argumentOfPeriapsis; // radians
+        ScalarType trueAnomaly; // radians
+
+        static constexpr auto gravitationalConstant() -> ScalarType { return ScalarType(Body::mu); }
+
+        auto toKeplerian() const -> KeplerianElements<ScalarType>
+        {
+            return {semiMajorAxis, eccentricity, inclination, rightAscensionAscendingNode, argumentOfPeriapsis,
+                    trueAnomaly, gravitationalConstant()};
+        }
+    };
+
+
+    /// Kepler propagation about Body, with mu and its square root folded into the solver.
+    template<typename Body, typename ScalarType>
+    using BodyKeplerPropagator = KeplerPropagator<ScalarType, BodyGravity<Body, ScalarType>>;
+
+
+    template<typename Body, typename ScalarType>
+    auto toState(const BodyElements<Body, ScalarType> &elements) -> StateVector<ScalarType>
+    {
+        return stateFromElements(elements, BodyGravity<Body, ScalarType>{});
+    }
+
+    /// Elements about Body of a state vector; call as toElements<Mars>(state).
+    template<typename Body, typename ScalarType>
+    auto toElements(const StateVector<ScalarType> &state) -> BodyElements<Body, ScalarType>
+    {
+        BodyElements<Body, ScalarType> elements{};
+        elementsFromState(state, BodyGravity<Body, ScalarType>{}, elements);
+        return elements;
+    }
+
+    /// Cowell point mass plus J2 propagation about Body.
+    template<typename Body, typename ScalarType>
+    auto j2PropagatorFor(ScalarType maxStep = 30) -> J2Propagator<ScalarType>
+    {
+        return J2Propagator<ScalarType>{ScalarType(Body::mu), ScalarType(Body::j2), ScalarType(Body::radius), maxStep};
+    }
+
+    /// Closed form secular J2 drift of elements about Body, from epoch seconds past J2000.
+    template<typename Body, typename ScalarType>
+    auto secularJ2PropagatorFor(const BodyElements<Body, ScalarType> &elements, double epoch = 0)
+            -> SecularJ2Propagator<ScalarType>
+    {
+        return SecularJ2Propagator<ScalarType>{elements.toKeplerian(), epoch, ScalarType(Body::j2),
+                                               ScalarType(Body::radius)};
+    }
+}
+
+#endif //ORBIT_BODIES_HPP
+#pragma clang diagnostic pop
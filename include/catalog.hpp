@@ -0,0 +1,280 @@
+// -*- mode: c++ -*-
+////
+// Catalog of orbits that keeps the state vectors derived from them at each requested epoch, and on every later
+// request recomputes only the objects whose elements changed since, in parallel.  With a few percent of a catalog
+// changing per cycle, a cycle costs a few percent of a full recompute.
+//
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
+
+#ifndef ORBIT_CATALOG_HPP
+#define ORBIT_CATALOG_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "orbit.hpp"
+#include "parallel.hpp"
+#include "propagator.hpp"
+
+namespace orbit {
+    /// Cache effectiveness of an IncrementalCatalog, counted per object state, since construction or reset.
+    struct CatalogStatistics {
+        std::uint64_t hits = 0;             // states already current in a cache
+        std::uint64_t misses = 0;           // states computed, each one a recomputation from the elements
+        std::uint64_t evaluations = 0;      // calls to states() and state()
+        std::uint64_t epochsCreated = 0;    // per-epoch caches started from nothing
+        std::uint64_t epochsEvicted = 0;    // least recently used caches given up for a new epoch
+        std::uint64_t fullScans = 0;        // caches that fell behind the change log and compared every version
+
+        auto hitRate() const -> double { return hits + misses > 0 ? double(hits)/double(hits + misses) : 0.0; }
+
+        auto missRate() const -> double { return hits + misses > 0 ? double(misses)/double(hits + misses) : 0.0; }
+    };
+
+
+    /**
+     * Objects are numbered in the order added.  Each update bumps the object's version and appends it to a change
+     * log; each epoch cache remembers how far into the log it is current, so bringing it up to date touches only
+     * the objects changed since, whatever the catalog size.  When the log grows past the catalog size it is dropped
+     * and caches behind it compare versions instead.  Epochs are matched exactly, and at most maxEpochs are kept.
+     * Not safe for concurrent calls; the parallelism is inside states().
+     * @tparam ScalarType float or double.
+     * @tparam Model Built from (KeplerianElements, epoch) and giving propagate(double t) -> StateVector.
+     */
+    template<typename ScalarType, typename Model = SecularJ2Propagator<ScalarType>>
+    class IncrementalCatalog {
+    public:
+        using stateType = StateVector<ScalarType>;
+
+        /**
+         * @param maxEpochs0 Epochs to keep states for, least recently used dropped first.
+         * @param workers0 Threads for recomputation, 0 for one per hardware thread.
+         */
+        explicit IncrementalCatalog(std::size_t maxEpochs0 = 4, unsigned workers0 = 0)
+                : maxEpochs{std::max<std::size_t>(1, maxEpochs0)}, workers{workers0}
+        {
+            caches.reserve(maxEpochs);
+        }
+
+        auto size() const -> std::size_t { return models.size(); }
+
+        /// Append an object, returning its index.
+        auto add(const Model &model) -> std::size_t;
+
+        /// Append an object whose elements hold at epoch, seconds past J2000.
+        auto add(const KeplerianElements<ScalarType> &elements, double epoch) -> std::size_t
+        {
+            return add(Model{elements, epoch});
+        }
+
+        /// Replace an object, marking it dirty in every epoch cache.
+        auto update(std::size_t id, const Model &model) -> void;
+
+        auto update(std::size_t id, const KeplerianElements<ScalarType> &elements, double epoch) -> void
+        {
+            update(id, Model{elements, epoch});
+        }
+
+        auto model(std::size_t id) const -> const Model & { return models.at(id); }
+
+        /// Objects changed since the cache for epoch t was last brought up to date; all of them if there is none.
+        auto dirtyCount(double t) const -> std::size_t;
+
+        /// States of every object at t, recomputing only those changed since the last call for t.  The reference
+        /// stays valid until the next call that adds, updates or evaluates a different epoch.
+        auto states(double t) -> const std::vector<stateType> &;
+
+        /// State of one object at t, from the cache for t when it is current.
+        auto state(std::size_t id, double t) -> stateType;
+
+        auto statistics() const -> const CatalogStatistics & { return counts; }
+
+        auto resetStatistics() -> void { counts = CatalogStatistics{}; }
+
+        /// Drop every cached state.
+        auto clearCache() -> void { caches.clear(); }
+
+    private:
+        struct EpochCache {
+            double epoch;
+            std::vector<stateType> states;
+            std::vector<std::uint64_t> versions;    // version of the object each state was computed from, 0 none
+            std::size_t synced = 0;                 // change log position this cache is current to
+            bool scan = true;                       // compare every version rather than read the log
+            std::uint64_t lastUse = 0;
+        };
+
+        auto find(double t) -> EpochCache *;
+
+        auto findOrCreate(double t) -> EpochCache &;
+
+        auto logPosition() const -> std::size_t { return changeBase + changes.size(); }
+
+        /// Objects the cache is stale for, sorted.
+        auto stale(const EpochCache &) const -> std::vector<std::size_t>;
+
+        auto trimLog() -> void;
+
+        std::size_t maxEpochs;
+        unsigned workers;
+        std::vector<Model> models;
+        std::vector<std::uint64_t> versions;
+        std::vector<std::size_t> changes;   // objects added or updated, oldest first
+        std::size_t changeBase = 0;         // log position of changes.front()
+        std::vector<EpochCache> caches;
+        std::uint64_t useClock = 0;
+        CatalogStatistics counts;
+    };
+
+
+    template<typename ScalarType, typename Model>
+    auto IncrementalCatalog<ScalarType, Model>::add(const Model &model) -> std::size_t
+    {
+        models.push_back(model);
+        versions.push_back(1);
+        changes.push_back(models.size() - 1);
+        trimLog();
+        return models.size() - 1;
+    }
+
+
+    template<typename ScalarType, typename Model>
+    auto IncrementalCatalog<ScalarType, Model>::update(std::size_t id, const Model &model) -> void
+    {
+        if (id >= models.size()) throw std::out_of_range{"IncrementalCatalog::update: no such object"};
+        models[id] = model;
+        ++versions[id];
+        changes.push_back(id);
+        trimLog();
+    }
+
+
+    template<typename ScalarType, typename Model>
+    auto IncrementalCatalog<ScalarType, Model>::find(double t) -> EpochCache *
+    {
+        for (auto &cache: caches) {
+            if (cache.epoch == t) {
+                cache.lastUse = ++useClock;
+                return &cache;
+            }
+        }
+        return nullptr;
+    }
+
+
+    template<typename ScalarType, typename Model>
+    auto IncrementalCatalog<ScalarType, Model>::findOrCreate(double t) -> EpochCache &
+    {
+        if (auto cache = find(t)) return *cache;
+        ++counts.epochsCreated;
+        if (caches.size() < maxEpochs) {
+            caches.push_back(EpochCache{});
+        } else {
+            ++counts.epochsEvicted;
+        }
+        // Reuse the least recently used cache's storage; every state is recomputed anyway.
+        auto &cache = *std::min_element(caches.begin(), caches.end(), [](const auto &a, const auto &b) {
+            return a.lastUse < b.lastUse;
+        });
+        cache.epoch = t;
+        std::fill(cache.versions.begin(), cache.versions.end(), 0);
+        cache.scan = true;
+        cache.lastUse = ++useClock;
+        return cache;
+    }
+
+
+    template<typename ScalarType, typename Model>
+    auto IncrementalCatalog<ScalarType, Model>::stale(const EpochCache &cache) const -> std::vector<std::size_t>
+    {
+        std::vector<std::size_t> ids;
+        auto isStale = [&](std::size_t id) { return id >= cache.versions.size() || cache.versions[id] != versions[id]; };
+        if (cache.scan || cache.synced < changeBase) {
+            for (std::size_t id = 0; id < models.size(); ++id) if (isStale(id)) ids.push_back(id);
+            return ids;
+        }
+        for (auto k = cache.synced - changeBase; k < changes.size(); ++k) {
+            if (isStale(changes[k])) ids.push_back(changes[k]);
+        }
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        return ids;
+    }
+
+
+    template<typename ScalarType, typename Model>
+    auto IncrementalCatalog<ScalarType, Model>::dirtyCount(double t) const -> std::size_t
+    {
+        for (const auto &cache: caches) if (cache.epoch == t) return stale(cache).size();
+        return models.size();
+    }
+
+
+    template<typename ScalarType, typename Model>
+    auto IncrementalCatalog<ScalarType, Model>::states(double t) -> const std::vector<stateType> &
+    {
+        ++counts.evaluations;
+        auto &cache = findOrCreate(t);
+        if (cache.synced < changeBase && !cache.scan) ++counts.fullScans;
+        auto dirty = stale(cache);
+        cache.states.resize(models.size());
+        cache.versions.resize(models.size(), 0);
+
+        // Chunks of 64 propagations, so a query with few stale objects does not pay for starting threads.
+        numutil::parallelFor(dirty.size(), [&](std::size_t begin, std::size_t end, unsigned) {
+            for (auto k = begin; k < end; ++k) cache.states[dirty[k]] = models[dirty[k]].propagate(t);
+        }, workers, 64);
+        for (auto id: dirty) cache.versions[id] = versions[id];
+
+        counts.misses += dirty.size();
+        counts.hits += models.size() - dirty.size();
+        cache.synced = logPosition();
+        cache.scan = false;
+        trimLog();
+        return cache.states;
+    }
+
+
+    template<typename ScalarType, typename Model>
+    auto IncrementalCatalog<ScalarType, Model>::state(std::size_t id, double t) -> stateType
+    {
+        if (id >= models.size()) throw std::out_of_range{"IncrementalCatalog::state: no such object"};
+        ++counts.evaluations;
+        auto cache = find(t);
+        if (cache != nullptr && id < cache->versions.size() && cache->versions[id] == versions[id]) {
+            ++counts.hits;
+            return cache->states[id];
+        }
+        ++counts.misses;
+        auto result = models[id].propagate(t);
+        if (cache != nullptr && id < cache->versions.size()) {
+            cache->states[id] = result;
+            cache->versions[id] = versions[id];
+        }
+        return result;
+    }
+
+
+    template<typename ScalarType, typename Model>
+    auto IncrementalCatalog<ScalarType, Model>::trimLog() -> void
+    {
+        // Drop the entries every cache still reading the log has read, or everything once the log outgrows a scan of
+        // the catalog.  Erasing only when at least half the log goes keeps the cost per change constant.
+        auto oldest = logPosition();
+        for (const auto &cache: caches) {
+            if (!cache.scan && cache.synced >= changeBase) oldest = std::min(oldest, cache.synced);
+        }
+        if (changes.size() > models.size()) oldest = logPosition();
+        if (oldest > changeBase && (oldest - changeBase)*2 >= changes.size()) {
+            changes.erase(changes.begin(), changes.begin() + long(oldest - changeBase));
+            changeBase = oldest;
+        }
+    }
+}
+
+#endif //ORBIT_CATALOG_HPP
+#pragma clang diagnostic pop
@@ -10,13 +10,23 @@
 #define ORBIT_CONSTANTS_HPP
 
 namespace orbit {
-    static const auto bigG = 6.67430e-11; // N*m^2/kg^2
-    static const auto earthMass = 5.972168e24; // kg
-    static const auto muEarth = bigG*earthMass;
-    static const auto earthRadius = 6371.0; // km
-    static const auto earthEquatorialRadius = 6378.137; // km
-    static const auto earthPolarRadius = 6356.752; // km
-    static const auto earthFlattening = 1.0/298.257222101;
+    inline constexpr auto bigG = 6.67430e-11; // N*m^2/kg^2
+    inline constexpr auto earthMass = 5.972168e24; // kg
+    inline constexpr auto muEarth = bigG*earthMass;
+    inline constexpr auto earthRadius = 6371.0; // km
+    inline constexpr auto earthEquatorialRadius = 6378.137; // km
+    inline constexpr auto earthPolarRadius = 6356.752; // km
+    inline constexpr auto earthFlattening = 1.0/298.257222101;
+    inline constexpr auto earthJ2 = 1.08262668e-3; // dimensionless, EGM2008 unnormalized zonal
+    inline constexpr auto muEarthEGM = 3.986004415e14; // m^3/s^2, EGM2008 and EGM96 reference GM (Pavlis et al. 2012)
+    inline constexpr auto earthRadiusEGM = 6378136.3; // m, EGM2008 and EGM96 reference radius
+    inline constexpr auto muSun = 1.32712440018e20; // m^3/s^2
+    inline constexpr auto muMoon = 4.9028e12; // m^3/s^2
+    inline constexpr auto sunRadius = 6.957e8; // m
+    inline constexpr auto moonRadius = 1.7374e6; // m
+    inline constexpr auto astronomicalUnit = 1.495978707e11; // m
+    inline constexpr auto solarPressure = 4.56e-6; // N/m^2, solar radiation pressure at 1 AU
+    inline constexpr auto obliquityJ2000 = 0.40909280422232897; // radians, 23.43929111 degrees
 
     // Earth J2000 Osculating Elements
     // Unix time is loosely based on UTC(NIST) but without leap seconds.  UTC = Unix Time + leap seconds
@@ -27,14 +37,14 @@ namespace orbit {
     //  Serious astrometry should refer to the Standards of Fundamental Astronomy https://www.iausofa.org/
     //  J2000 is an offset from UT1 (aka UT) astronomical time.
     //  for conversions between the various co-ordinate systems and time standards.
-    static const auto J2000 = 946728000.0; // Unix time at Sat Jan 01 2000 12:00:00 GMT+0000
-    static const auto JD200 = 2451545.0; // Terrestrial Time (TT) at J2000
-    static const auto J200TAI = 3.725E-04; // Offset between TAI and J2000. (January 1, 2000, 11:59:27.816 TAI)
-    static const auto J2000UTC = 7.428704E-04; // Offset between UTC and J200 (January 1, 2000, 11:58:55.816 UTC)
-    static const auto GPStoTAI = 18.0; // Seconds TAI is always 18 seconds ahead of GPS time
+    inline constexpr auto J2000 = 946728000.0; // Unix time at Sat Jan 01 2000 12:00:00 GMT+0000
+    inline constexpr auto JD200 = 2451545.0; // Terrestrial Time (TT) at J2000
+    inline constexpr auto J200TAI = 3.725E-04; // Offset between TAI and J2000. (January 1, 2000, 11:59:27.816 TAI)
+    inline constexpr auto J2000UTC = 7.428704E-04; // Offset between UTC and J200 (January 1, 2000, 11:58:55.816 UTC)
+    inline constexpr auto GPStoTAI = 18.0; // Seconds TAI is always 18 seconds ahead of GPS time
 
     // Leap seconds (June 30, Dec 31) 1972 to 2023
-    static const int leapSeconds[][2] = {
+    inline constexpr int leapSeconds[][2] = {
             {1, 1}, // 1972
             {0, 1},
             {0, 1},
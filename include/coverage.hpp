@@ -0,0 +1,246 @@
+// -*- mode: c++ -*-
+////
+// Ground tracks and coverage rasters.  Propagated positions become sub-satellite points and sensor footprints, and
+// the footprints are rasterized onto a global latitude and longitude grid that keeps, for every cell, enough about
+// its access history to give coverage, revisit and gap statistics at the end.  Time is split into contiguous blocks,
+// each rasterized into its own grid by one worker; adjacent blocks merge exactly, so the result does not depend on
+// the number of workers.
+//
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
+
+#ifndef ORBIT_COVERAGE_HPP
+#define ORBIT_COVERAGE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include "constants.hpp"
+#include "parallel.hpp"
+#include "propagator.hpp"
+#include "vector3.hpp"
+
+namespace orbit {
+    /// Earth rotation angle, radians in [0, 2 pi), at t seconds past J2000 taken as UT1 (IERS Conventions 2010, 5.15).
+    inline auto earthRotationAngle(double t) -> double
+    {
+        auto days = t/86400.0;
+        auto turns = (days - std::floor(days)) + 0.7790572732640 + 0.00273781191135448*days;
+        return 2.0*std::numbers::pi*(turns - std::floor(turns));
+    }
+
+    /// Rotate an inertial position into the Earth fixed frame, ignoring precession, nutation and polar motion.
+    template<typename ScalarType>
+    auto earthFixed(const numutil::Vector3<ScalarType> &r, double t) -> numutil::Vector3<ScalarType>
+    {
+        auto theta = earthRotationAngle(t);
+        auto c = ScalarType(std::cos(theta));
+        auto s = ScalarType(std::sin(theta));
+        return {c*r[0] + s*r[1], c*r[1] - s*r[0], r[2]};
+    }
+
+    struct GroundPoint {
+        double latitude;    // geodetic, radians
+        double longitude;   // radians in [-pi, pi]
+        double altitude;    // meters above the WGS 84 ellipsoid
+    };
+
+    /// Point on the ellipsoid below an inertial position at t, with Bowring's single iteration (centimeters in LEO).
+    template<typename ScalarType>
+    auto subSatellitePoint(const numutil::Vector3<ScalarType> &r, double t) -> GroundPoint
+    {
+        auto fixed = earthFixed(r, t);
+        double x = fixed[0], y = fixed[1], z = fixed[2];
+        const auto a = earthEquatorialRadius*1.0e3;
+        const auto b = a*(1.0 - earthFlattening);
+        const auto e2 = earthFlattening*(2.0 - earthFlattening);
+        const auto ep2 = e2/(1.0 - e2);
+        auto p = std::hypot(x, y);
+        auto beta = std::atan2(a*z, b*p);
+        auto latitude = std::atan2(z + ep2*b*std::pow(std::sin(beta), 3), p - e2*a*std::pow(std::cos(beta), 3));
+        auto sinLatitude = std::sin(latitude);
+        auto n = a/std::sqrt(1.0 - e2*sinLatitude*sinLatitude);
+        auto altitude = std::abs(latitude) < 1.4 ? p/std::cos(latitude) - n : z/sinLatitude - n*(1.0 - e2);
+        return {latitude, std::atan2(y, x), altitude};
+    }
+
+    /// Sub-satellite points of orbit every step seconds over [start, end].
+    template<typename ScalarType>
+    auto groundTrack(const SecularJ2Propagator<ScalarType> &orbit, double start, double end, double step)
+            -> std::vector<GroundPoint>
+    {
+        if (!(step > 0)) throw std::invalid_argument{"groundTrack: step must be positive"};
+        std::vector<GroundPoint> track;
+        for (auto k = 0.0; start + k*step <= end; k += 1.0) {
+            auto t = start + k*step;
+            track.push_back(subSatellitePoint(orbit.position(t), t));
+        }
+        return track;
+    }
+
+
+    /**
+     * Nadir pointing conical sensor, limited by its half angle and by a minimum elevation of the satellite seen from
+     * the ground, over a spherical Earth of equatorial radius (Wertz, Space Mission Analysis and Design, 5.2).
+     */
+    struct Sensor {
+        double halfAngle = std::numbers::pi/2;  // radians off nadir
+        double minElevation = 0;                // radians
+
+        /// Earth central angle, radians, from the sub-satellite point to the footprint edge at a distance radius
+        /// from the Earth center.
+        auto footprintAngle(double radius) const -> double
+        {
+            auto sinRho = std::min(1.0, earthEquatorialRadius*1.0e3/radius);
+            auto nadir = std::min(halfAngle, std::asin(sinRho*std::cos(minElevation)));
+            return std::numbers::pi/2 - nadir - std::acos(std::min(1.0, std::sin(nadir)/sinRho));
+        }
+    };
+
+
+    /// Access history of one grid cell over a span of steps, kept in a form two adjacent spans can merge.
+    struct CoverageCell {
+        static const std::int32_t never = -2;
+
+        std::int32_t first = never;     // first step covered
+        std::int32_t last = never;      // last step covered
+        std::int32_t lastStart = never; // first step of the last access
+        std::uint32_t covered = 0;      // steps covered
+        std::uint32_t gaps = 0;         // gaps between accesses, one fewer than the accesses
+        std::uint32_t gapSum = 0;       // steps uncovered between the first and last access
+        std::uint32_t gapMax = 0;       // longest gap, steps
+
+        auto accesses() const -> std::uint32_t { return first == never ? 0 : gaps + 1; }
+    };
+
+
+    /// Area weighted summary of a coverage grid.  Times are in seconds, resolved to the step.
+    struct CoverageStatistics {
+        double coverage = 0;        // fraction of the Earth's area accessed at least once
+        double timeCoverage = 0;    // fraction of the area and time covered, the mean number of steps in view
+        double revisited = 0;       // fraction of the area accessed at least twice
+        double meanRevisit = 0;     // mean time between starts of successive accesses, over the area revisited
+        double meanGap = 0;         // mean time between the end of an access and the start of the next
+        double maxGap = 0;          // longest gap anywhere
+        double meanMaxGap = 0;      // longest gap of each cell, averaged over the area revisited
+    };
+
+
+    /**
+     * Global grid of square cells, resolution degrees on a side, rows from the south pole and columns from 180 degrees
+     * west, over geocentric latitude.  Cells are stored in square tiles of tileSize cells on a side, so a footprint
+     * touches a few compact blocks of memory rather than one cache line per row; a tileSize of 1 gives plain row
+     * major order.  A cell is covered at a step when its center is inside a footprint.  Steps must be added to a grid
+     * in nondecreasing order.  Each cell takes sizeof(CoverageCell), 28 bytes, so a grid at 0.1 degrees holds 6.48
+     * million cells in about 181 MB, and more with edge tiles padded; storageBytes gives the exact figure.
+     */
+    class CoverageGrid {
+    public:
+        explicit CoverageGrid(double resolution0, std::size_t tileSize0 = 32);
+
+        auto resolution() const -> double { return resolutionDegrees; }
+
+        auto rows() const -> std::size_t { return rowCount; }
+
+        auto columns() const -> std::size_t { return columnCount; }
+
+        auto tileSize() const -> std::size_t { return tile; }
+
+        /// Memory held by the cells of a grid of the given resolution and tiling, bytes.
+        static auto storageBytes(double resolution, std::size_t tileSize = 32) -> std::size_t;
+
+        auto cell(std::size_t row, std::size_t column) const -> const CoverageCell &
+        {
+            return cells[rowOffsets.at(row) + columnOffsets.at(column)];
+        }
+
+        /// Cover every cell within angle radians of the center at geocentric latitude and longitude, at step.
+        auto add(double latitude, double longitude, double angle, std::int32_t step) -> void;
+
+        /// Append the history of a grid over the steps immediately following this one's.
+        auto merge(const CoverageGrid &later, unsigned workers = 0) -> void;
+
+        /// Summary over a span of steps of step seconds each.
+        auto statistics(std::int32_t steps, double step) const -> CoverageStatistics;
+
+    private:
+        auto mark(CoverageCell &, std::int32_t step) -> void;
+
+        double resolutionDegrees;
+        std::size_t tile;
+        std::size_t rowCount;
+        std::size_t columnCount;
+        std::vector<std::size_t> rowOffsets;    // storage offset of each row's first column
+        std::vector<std::size_t> columnOffsets; // storage offset of each column within a row
+        std::vector<double> rowSines;           // sine of each row center's latitude
+        std::vector<double> rowCosines;
+        std::vector<CoverageCell> cells;
+    };
+
+
+    struct CoverageReport {
+        CoverageGrid grid;
+        CoverageStatistics statistics;
+        std::int32_t steps;
+        unsigned blocks;    // time blocks rasterized in parallel, each into its own grid
+    };
+
+
+    /**
+     * Rasterize the footprints of a constellation every step seconds over [start, end] at resolution degrees.
+     * Time is split into contiguous blocks, one per worker, each rasterized into its own grid and merged in time order
+     * at the end.  Every block costs a whole grid, CoverageGrid::storageBytes, so the number of blocks, and with it
+     * the parallelism, is capped to what fits in memoryBudget; at least one block always runs.  Each grid is freed as
+     * soon as it is merged.
+     * @param constellation Orbits, each seen by the same sensor.
+     * @param workers Number of threads, 0 for one per hardware thread.
+     * @param tileSize Cells on a side of each storage tile.
+     * @param memoryBudget Bytes the grids may take together.
+     */
+    template<typename ScalarType>
+    auto computeCoverage(std::span<const SecularJ2Propagator<ScalarType>> constellation, const Sensor &sensor,
+                         double start, double end, double step, double resolution, unsigned workers = 0,
+                         std::size_t tileSize = 32, std::size_t memoryBudget = std::size_t{1} << 30) -> CoverageReport
+    {
+        if (!(step > 0) || !(end >= start)) throw std::invalid_argument{"computeCoverage: empty or backward span"};
+        auto steps = static_cast<std::int32_t>(std::floor((end - start)/step)) + 1;
+        auto affordable = std::max<std::size_t>(1, memoryBudget/CoverageGrid::storageBytes(resolution, tileSize));
+        auto blocks = numutil::workerCount(std::size_t(steps), unsigned(std::min<std::size_t>(
+                affordable, workers == 0 ? numutil::defaultConcurrency() : workers)));
+
+        std::vector<std::optional<CoverageGrid>> grids(blocks);
+        numutil::parallelFor(blocks, [&](std::size_t begin, std::size_t last, unsigned) {
+            for (auto block = begin; block < last; ++block) {
+                auto &grid = grids[block].emplace(resolution, tileSize);
+                auto first = static_cast<std::int32_t>(std::size_t(steps)*block/blocks);
+                auto stop = static_cast<std::int32_t>(std::size_t(steps)*(block + 1)/blocks);
+                for (auto k = first; k < stop; ++k) {
+                    auto t = start + k*step;
+                    for (const auto &orbit: constellation) {
+                        auto r = earthFixed(orbit.position(t), t);
+                        double radius = r.norm();
+                        grid.add(std::asin(double(r[2])/radius), std::atan2(double(r[1]), double(r[0])),
+                                 sensor.footprintAngle(radius), k);
+                    }
+                }
+            }
+        }, blocks, 1);
+
+        for (auto block = 1u; block < blocks; ++block) {
+            grids.front()->merge(*grids[block], workers);
+            grids[block].reset();
+        }
+        auto statistics = grids.front()->statistics(steps, step);
+        return {std::move(*grids.front()), statistics, steps, blocks};
+    }
+}
+
+#endif //ORBIT_COVERAGE_HPP
+#pragma clang diagnostic pop
@@ -0,0 +1,265 @@
+// -*- mode: c++ -*-
+////
+// Orbit determination from position observations: Gibbs and Herrick-Gibbs initial orbit determination and batch
+// least-squares (Gauss-Newton) differential correction using the analytic two-body state transition matrix.
+//
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedStructInspection"
+#pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
+
+#ifndef ORBIT_DETERMINATION_HPP
+#define ORBIT_DETERMINATION_HPP
+
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include "constants.hpp"
+#include "orbit.hpp"
+#include "parallel.hpp"
+#include "propagator.hpp"
+#include "vector3.hpp"
+
+namespace orbit {
+    /// One inertial position measurement.
+    template<typename ScalarType>
+    struct PositionObservation {
+        ScalarType time;                        // seconds
+        numutil::Vector3<ScalarType> position;  // same units as mu
+        ScalarType sigma = 1;                   // one-sigma noise per axis
+    };
+
+
+    /// Outcome of fitting one track.
+    template<typename ScalarType>
+    struct FitResult {
+        StateVector<ScalarType> state;  // estimated state at epoch
+        ScalarType epoch = 0;
+        ScalarType rms = 0;             // RMS of residual/sigma per axis
+        int iterations = 0;
+        bool converged = false;
+    };
+
+
+    /**
+     * Velocity at r2 from three coplanar position vectors by the Gibbs method.
+     * Needs well separated vectors; prefer herrickGibbs when they are within a few degrees of each other.
+     */
+    template<typename ScalarType>
+    auto gibbs(const numutil::Vector3<ScalarType> &r1, const numutil::Vector3<ScalarType> &r2,
+               const numutil::Vector3<ScalarType> &r3, ScalarType mu = orbit::muEarth) -> StateVector<ScalarType>
+    {
+        auto r1Norm = r1.norm();
+        auto r2Norm = r2.norm();
+        auto r3Norm = r3.norm();
+        auto c12 = r1.cross(r2);
+        auto c23 = r2.cross(r3);
+        auto c31 = r3.cross(r1);
+
+        auto n = r1Norm*c23 + r2Norm*c31 + r3Norm*c12;
+        auto d = c12 + c23 + c31;
+        auto s = (r2Norm - r3Norm)*r1 + (r3Norm - r1Norm)*r2 + (r1Norm - r2Norm)*r3;
+
+        auto v2 = d.cross(r2)*(1/r2Norm) + s;
+        v2 *= std::sqrt(mu/(n.norm()*d.norm()));
+        return {r2, v2};
+    }
+
+
+    /// Velocity at r2 from three closely spaced, time tagged position vectors by the Herrick-Gibbs method.
+    template<typename ScalarType>
+    auto herrickGibbs(const numutil::Vector3<ScalarType> &r1, const numutil::Vector3<ScalarType> &r2,
+                      const numutil::Vector3<ScalarType> &r3, ScalarType t1, ScalarType t2, ScalarType t3,
+                      ScalarType mu = orbit::muEarth) -> StateVector<ScalarType>
+    {
+        auto dt21 = t2 - t1;
+        auto dt31 = t3 - t1;
+        auto dt32 = t3 - t2;
+        auto term = [mu](const numutil::Vector3<ScalarType> &r) { auto n = r.norm(); return mu/(12*n*n*n); };
+
+        auto v2 = (-dt32*(1/(dt21*dt31) + term(r1)))*r1
+                  + ((dt32 - dt21)*(1/(dt21*dt32) + term(r2)))*r2
+                  + (dt21*(1/(dt32*dt31) + term(r3)))*r3;
+        return {r2, v2};
+    }
+
+
+    /**
+     * Initial orbit from three observations, state at the time of the second.  Uses Gibbs when the vectors are
+     * separated by more than minimumGibbsAngle and Herrick-Gibbs otherwise.
+     */
+    template<typename ScalarType>
+    auto initialOrbit(const PositionObservation<ScalarType> &o1, const PositionObservation<ScalarType> &o2,
+                      const PositionObservation<ScalarType> &o3, ScalarType mu = orbit::muEarth,
+                      ScalarType minimumGibbsAngle = ScalarType(3.0*std::numbers::pi/180.0)) -> StateVector<ScalarType>
+    {
+        if (std::min(o1.position.angle(o2.position), o2.position.angle(o3.position)) < minimumGibbsAngle) {
+            return herrickGibbs(o1.position, o2.position, o3.position, o1.time, o2.time, o3.time, mu);
+        }
+        return gibbs(o1.position, o2.position, o3.position, mu);
+    }
+
+
+    /**
+     * Weighted batch least-squares differential correction of a two-body state against position observations.
+     * All scratch storage is fixed size and held in the instance, so one instance per thread fits any number of
+     * tracks without allocating.
+     * @tparam ScalarType float or double.
+     */
+    template<typename ScalarType>
+    class BatchLeastSquares {
+    public:
+        using observationType = PositionObservation<ScalarType>;
+        using resultType = FitResult<ScalarType>;
+
+        explicit BatchLeastSquares(ScalarType mu0 = orbit::muEarth, int maxIterations0 = 20,
+                                   ScalarType tolerance0 = std::sqrt(std::numeric_limits<ScalarType>::epsilon()))
+                : propagator{mu0}, maxIterations{maxIterations0}, tolerance{tolerance0} {}
+
+        /// Refine guess, a state at epoch, against the observations.
+        auto fit(const StateVector<ScalarType> &guess, ScalarType epoch,
+                 std::span<const observationType> observations) -> resultType;
+
+        /// Initial orbit from the first, middle and last observations, then refine it at the middle epoch.
+        auto fit(std::span<const observationType> observations) -> resultType;
+
+    private:
+        /// Solve normal * x = rhs in place by Jacobi scaled Cholesky.  False if normal is not positive definite.
+        auto solveNormal() -> bool;
+
+        KeplerPropagator<ScalarType> propagator;
+        int maxIterations;
+        ScalarType tolerance;
+
+        Matrix6x6<ScalarType> stm{};
+        Matrix6x6<ScalarType> normal{};
+        std::array<ScalarType, 6> rhs{};
+        std::array<ScalarType, 6> scale{};
+    };
+
+
+    template<typename ScalarType>
+    auto BatchLeastSquares<ScalarType>::fit(const StateVector<ScalarType> &guess, ScalarType epoch,
+                                            std::span<const observationType> observations) -> resultType
+    {
+        resultType result;
+        result.state = guess;
+        result.epoch = epoch;
+        if (observations.size() < 2) return result;
+
+        while (result.iterations < maxIterations) {
+            ++result.iterations;
+            for (auto &row: normal) row.fill(0);
+            rhs.fill(0);
+
+            ScalarType sumSquares = 0;
+            for (const auto &observation: observations) {
+                auto predicted = propagator.propagate(result.state, observation.time - epoch, stm);
+                auto residual = observation.position - predicted.r;
+                auto weight = 1/(observation.sigma*observation.sigma);
+                sumSquares += weight*residual.dot(residual);
+                // Position rows of the state transition matrix are the measurement partials.
+                for (auto i = 0; i < 6; ++i) {
+                    for (auto k = 0; k < 3; ++k) rhs[i] += weight*stm[k][i]*residual[k];
+                    for (auto j = i; j < 6; ++j) {
+                        ScalarType sum = 0;
+                        for (auto k = 0; k < 3; ++k) sum += stm[k][i]*stm[k][j];
+                        normal[i][j] += weight*sum;
+                    }
+                }
+            }
+            result.rms = std::sqrt(sumSquares/ScalarType(3*observations.size()));
+            for (auto i = 0; i < 6; ++i) {
+                for (auto j = 0; j < i; ++j) normal[i][j] = normal[j][i];
+            }
+
+            if (!solveNormal()) return result;
+            numutil::Vector3<ScalarType> dr{rhs.data()};
+            numutil::Vector3<ScalarType> dv{rhs.data() + 3};
+            result.state.r += dr;
+            result.state.v += dv;
+            if (!std::isfinite(dr.norm()) || !std::isfinite(dv.norm())) return result;
+            if (dr.norm() <= tolerance*result.state.r.norm() && dv.norm() <= tolerance*result.state.v.norm()) {
+                result.converged = true;
+                break;
+            }
+        }
+        return result;
+    }
+
+
+    template<typename ScalarType>
+    auto BatchLeastSquares<ScalarType>::fit(std::span<const observationType> observations) -> resultType
+    {
+        if (observations.size() < 3) return {};
+        const auto &middle = observations[observations.size()/2];
+        auto guess = initialOrbit(observations.front(), middle, observations.back(),
+                                  propagator.gravitationalConstant());
+        return fit(guess, middle.time, observations);
+    }
+
+
+    template<typename ScalarType>
+    auto BatchLeastSquares<ScalarType>::solveNormal() -> bool
+    {
+        // Position and velocity partials differ by the arc length in seconds; scale to unit diagonal first.
+        for (auto i = 0; i < 6; ++i) {
+            if (!(normal[i][i] > 0)) return false;
+            scale[i] = 1/std::sqrt(normal[i][i]);
+        }
+        for (auto i = 0; i < 6; ++i) {
+            rhs[i] *= scale[i];
+            for (auto j = 0; j < 6; ++j) normal[i][j] *= scale[i]*scale[j];
+        }
+
+        // Cholesky factor into the lower triangle.
+        for (auto j = 0; j < 6; ++j) {
+            auto diagonal = normal[j][j];
+            for (auto k = 0; k < j; ++k) diagonal -= normal[j][k]*normal[j][k];
+            if (!(diagonal > 0)) return false;
+            normal[j][j] = std::sqrt(diagonal);
+            for (auto i = j + 1; i < 6; ++i) {
+                auto sum = normal[i][j];
+                for (auto k = 0; k < j; ++k) sum -= normal[i][k]*normal[j][k];
+                normal[i][j] = sum/normal[j][j];
+            }
+        }
+
+        for (auto i = 0; i < 6; ++i) {
+            for (auto k = 0; k < i; ++k) rhs[i] -= normal[i][k]*rhs[k];
+            rhs[i] /= normal[i][i];
+        }
+        for (auto i = 5; i >= 0; --i) {
+            for (auto k = i + 1; k < 6; ++k) rhs[i] -= normal[k][i]*rhs[k];
+            rhs[i] /= normal[i][i];
+        }
+        for (auto i = 0; i < 6; ++i) rhs[i] *= scale[i];
+        return true;
+    }
+
+
+    /**
+     * Fit every track independently on a pool of threads, one BatchLeastSquares workspace per thread.
+     * @param tracks Observations of each object, at least three per object, in time order.
+     * @param results One result per track, at least as many as tracks; throws std::invalid_argument otherwise.
+     * @param workers Number of threads, 0 for one per hardware thread.
+     */
+    template<typename ScalarType>
+    auto determineOrbits(std::span<const std::span<const PositionObservation<ScalarType>>> tracks,
+                         std::span<FitResult<ScalarType>> results, ScalarType mu = orbit::muEarth,
+                         unsigned workers = 0) -> void
+    {
+        if (results.size() < tracks.size()) throw std::invalid_argument{"determineOrbits: fewer results than tracks"};
+        std::vector<BatchLeastSquares<ScalarType>> solvers(numutil::workerCount(tracks.size(), workers),
+                                                           BatchLeastSquares<ScalarType>{mu});
+        numutil::parallelFor(tracks.size(), [&](std::size_t begin, std::size_t end, unsigned worker) {
+            for (auto k = begin; k < end; ++k) results[k] = solvers[worker].fit(tracks[k]);
+        }, workers);
+    }
+}
+
+#endif //ORBIT_DETERMINATION_HPP
+#pragma clang diagnostic pop
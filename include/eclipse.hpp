@@ -0,0 +1,240 @@
+// -*- mode: c++ -*-
+////
+// Umbra and penumbra entry and exit times for a catalog of orbits.  Each revolution is bracketed in closed form
+// against an inflated shadow cylinder, and only the brackets are refined against the conical shadow model, so the
+// cost per object grows with the number of eclipses rather than with the span over the sampling step.
+//
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedStructInspection"
+#pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
+
+#ifndef ORBIT_ECLIPSE_HPP
+#define ORBIT_ECLIPSE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "constants.hpp"
+#include "ephemeris.hpp"
+#include "parallel.hpp"
+#include "perturbations.hpp"
+#include "propagator.hpp"
+#include "roots.hpp"
+
+namespace orbit {
+    enum class ShadowEventType { penumbraEntry, umbraEntry, umbraExit, penumbraExit };
+
+    struct ShadowEvent {
+        double time;            // seconds past J2000
+        std::size_t object;     // index into the catalog
+        ShadowEventType type;
+
+        auto operator<(const ShadowEvent &other) const -> bool
+        {
+            return time < other.time || (time == other.time && object < other.object);
+        }
+    };
+
+
+    /**
+     * Finds shadow events of orbits moving under SecularJ2Propagator, with the Sun from a shared EphemerisCache.
+     *
+     * For every revolution the Sun direction and orbit orientation are frozen at mid revolution, which turns the
+     * squared distance from the shadow axis into a trigonometric polynomial in eccentric anomaly with a known
+     * Lipschitz bound.  Interval subdivision with that bound brackets every crossing of a cylinder widened to cover
+     * the penumbra cone and the motion of the Sun and orbit over half a revolution.  Within each bracket a golden
+     * section search finds the deepest point and Illinois iterations find the conical shadow boundaries.
+     * Read only after construction; one finder serves all threads.
+     * @tparam ScalarType float or double.
+     */
+    template<typename ScalarType>
+    class EclipseFinder {
+    public:
+        using orbitType = SecularJ2Propagator<ScalarType>;
+
+        /// The ephemeris must cover every span searched; tolerance is the event time accuracy in seconds.
+        explicit EclipseFinder(const EphemerisCache<ScalarType> &ephemeris0, double tolerance0 = 1.0e-3)
+                : ephemeris{&ephemeris0}, tolerance{tolerance0} {}
+
+        /// Time intervals in [start, end] that may hold shadow, each containing at most one passage.
+        auto brackets(const orbitType &orbit, double start, double end) const -> std::vector<std::pair<double, double>>;
+
+        /// Append the events of orbit in [start, end] to events, in time order.
+        auto find(const orbitType &orbit, double start, double end, std::vector<ShadowEvent> &events,
+                  std::size_t object = 0) const -> void;
+
+    private:
+        const EphemerisCache<ScalarType> *ephemeris;
+        double tolerance;
+    };
+
+
+    template<typename ScalarType>
+    auto EclipseFinder<ScalarType>::brackets(const orbitType &orbit, double start, double end) const
+            -> std::vector<std::pair<double, double>>
+    {
+        const auto twoPi = 2.0*std::numbers::pi;
+        const auto earth = earthEquatorialRadius*1.0e3;
+        double a = orbit.semiMajorAxis();
+        double e = orbit.eccentricity();
+        auto b = a*std::sqrt(1.0 - e*e);
+        auto period = orbit.period();
+
+        // Penumbra cone half angle plus how far the Sun and orbit turn in half a revolution, seen from apoapsis.
+        auto turn = (orbit.precessionRate() + twoPi/(365.25*86400.0))*period/2.0;
+        auto radius = earth + 1.1*a*(1.0 + e)*((sunRadius + earth)/(0.98*astronomicalUnit) + turn) + 1.0e3;
+        auto clampTime = [this](double t) { return std::clamp(t, ephemeris->startTime(), ephemeris->endTime()); };
+
+        std::vector<std::pair<double, double>> result;
+        auto add = [&](double first, double last) {
+            first = std::max(first, start);
+            last = std::min(last, end);
+            if (first >= last) return;
+            if (!result.empty() && first <= result.back().second + 1.0e-6*period) result.back().second = last;
+            else result.emplace_back(first, last);
+        };
+
+        for (auto revolution = std::floor(orbit.meanAnomaly(start)/twoPi);; revolution += 1.0) {
+            auto periapsis = orbit.timeOfMeanAnomaly(twoPi*revolution);
+            if (periapsis >= end) break;
+            auto middle = periapsis + period/2.0;
+            auto toInertial = orbit.orientation(middle);
+            auto sun = ephemeris->sun(clampTime(middle)).unit();
+            auto p = toInertial.transform({1, 0, 0}).dot(sun);
+            auto q = toInertial.transform({0, 1, 0}).dot(sun);
+
+            // u(E) = r.sun and f(E) = |r|^2 - u^2 - radius^2, negative inside the cylinder.
+            auto alpha = a*p;
+            auto beta = b*q;
+            auto gamma = -a*e*p;
+            auto amplitude = std::sqrt(alpha*alpha + beta*beta);
+            auto lipschitz = 2.0*a*a*e*(1.0 + e) + 2.0*(std::abs(gamma) + amplitude)*amplitude;
+            auto sunward = [&](double E) { return alpha*std::cos(E) + beta*std::sin(E) + gamma; };
+            auto f = [&](double E) {
+                auto rNorm = a*(1.0 - e*std::cos(E));
+                auto u = sunward(E);
+                return rNorm*rNorm - u*u - radius*radius;
+            };
+            auto time = [&](double E) { return periapsis + (E - e*std::sin(E))/orbit.meanMotion(); };
+
+            // Sign changes of f, each bracketed to within a thirty second of a revolution.
+            std::vector<std::pair<double, double>> crossings;
+            std::vector<std::pair<double, double>> stack;
+            const auto pieces = 16;
+            for (auto k = pieces; k > 0; --k) stack.emplace_back(twoPi*(k - 1)/pieces, twoPi*k/pieces);
+            while (!stack.empty()) {
+                auto [e0, e1] = stack.back();
+                stack.pop_back();
+                auto f0 = f(e0);
+                auto f1 = f(e1);
+                auto width = e1 - e0;
+                if ((f0 < 0) != (f1 < 0)) {
+                    if (width <= twoPi/32) {
+                        crossings.emplace_back(e0, e1);
+                        continue;
+                    }
+                } else if (std::abs(f0) + std::abs(f1) > lipschitz*width || width < 1.0e-9) {
+                    continue;
+                }
+                stack.emplace_back(e0 + width/2, e1);
+                stack.emplace_back(e0, e0 + width/2);
+            }
+
+            // Intervals inside the cylinder on the night side, widened to the outer ends of their crossings.
+            auto inside = f(0.0) < 0;
+            auto entry = 0.0;
+            for (auto [e0, e1]: crossings) {
+                if (!inside) {
+                    entry = e0;
+                } else if (sunward((entry + e0)/2) < 0) {
+                    add(time(entry), time(e1));
+                }
+                inside = !inside;
+            }
+            if (inside && sunward((entry + twoPi)/2) < 0) add(time(entry), time(twoPi));
+        }
+        return result;
+    }
+
+
+    template<typename ScalarType>
+    auto EclipseFinder<ScalarType>::find(const orbitType &orbit, double start, double end,
+                                         std::vector<ShadowEvent> &events, std::size_t object) const -> void
+    {
+        auto appended = events.size();
+        // Separation of the Sun and Earth disks less the sum (penumbra) or difference (umbra) of their radii.
+        auto penumbra = [&](double t) -> double {
+            auto [a, b, c] = shadowAngles(orbit.position(t), ephemeris->sun(t));
+            return c - a - b;
+        };
+        auto umbra = [&](double t) -> double {
+            auto [a, b, c] = shadowAngles(orbit.position(t), ephemeris->sun(t));
+            return c - b + a;
+        };
+
+        // Entry and exit of one boundary inside [first, last]; returns the interval found, empty if none.
+        auto passage = [&](auto g, double first, double last, ShadowEventType entry,
+                           ShadowEventType exit) -> std::pair<double, double> {
+            // A coarse search settles most passages; only grazing ones need the minimum pinned down.
+            auto coarse = std::max(tolerance, 1.0e-3*(last - first));
+            auto [deepest, depth] = numutil::minimize(g, first, last, coarse);
+            if (!(depth < 0) && coarse > tolerance) {
+                std::tie(deepest, depth) = numutil::minimize(g, std::max(first, deepest - coarse),
+                                                             std::min(last, deepest + coarse), tolerance);
+            }
+            if (!(depth < 0)) return {0.0, 0.0};
+            auto gFirst = g(first);
+            auto gLast = g(last);
+            if (gFirst > 0) first = numutil::findRoot(g, deepest, first, depth, gFirst, tolerance);
+            if (gFirst > 0) events.push_back({first, object, entry});
+            if (gLast > 0) last = numutil::findRoot(g, deepest, last, depth, gLast, tolerance);
+            if (gLast > 0) events.push_back({last, object, exit});
+            return {first, last};
+        };
+
+        for (auto [first, last]: brackets(orbit, start, end)) {
+            auto [enter, leave] = passage(penumbra, first, last, ShadowEventType::penumbraEntry,
+                                          ShadowEventType::penumbraExit);
+            if (enter < leave) passage(umbra, enter, leave, ShadowEventType::umbraEntry, ShadowEventType::umbraExit);
+        }
+        std::sort(events.begin() + std::ptrdiff_t(appended), events.end());
+    }
+
+
+    /**
+     * Shadow events of every orbit in a catalog over [start, end], computed in parallel.
+     * @return One time ordered list per object.
+     */
+    template<typename ScalarType>
+    auto findEclipses(const EclipseFinder<ScalarType> &finder, std::span<const SecularJ2Propagator<ScalarType>> catalog,
+                      double start, double end, unsigned workers = 0) -> std::vector<std::vector<ShadowEvent>>
+    {
+        std::vector<std::vector<ShadowEvent>> events(catalog.size());
+        numutil::parallelFor(catalog.size(), [&](std::size_t begin, std::size_t last, unsigned) {
+            for (auto k = begin; k < last; ++k) finder.find(catalog[k], start, end, events[k], k);
+        }, workers);
+        return events;
+    }
+
+
+    /// Merge per object lists into one list ordered by time, then object.
+    inline auto mergeEvents(const std::vector<std::vector<ShadowEvent>> &lists) -> std::vector<ShadowEvent>
+    {
+        std::vector<ShadowEvent> result;
+        std::size_t total = 0;
+        for (const auto &list: lists) total += list.size();
+        result.reserve(total);
+        for (const auto &list: lists) result.insert(result.end(), list.begin(), list.end());
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+}
+
+#endif //ORBIT_ECLIPSE_HPP
+#pragma clang diagnostic pop
@@ -0,0 +1,159 @@
+// -*- mode: c++ -*-
+////
+// Low precision analytic Sun and Moon positions (Montenbruck and Gill, Satellite Orbits, section 3.3.2) and a cache
+// that tabulates them once over an integration span for cheap interpolation from any number of threads.
+//
+// Times are seconds since J2000 (TT).  Positions are geocentric, mean equator and equinox of J2000, in meters.
+// Accuracy is about 0.1% for the Sun and a few hundred kilometers for the Moon, ample for perturbations.
+//
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
+
+#ifndef ORBIT_EPHEMERIS_HPP
+#define ORBIT_EPHEMERIS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+#include <vector>
+#include "constants.hpp"
+#include "vector3.hpp"
+
+namespace orbit {
+    /// Rotate ecliptic coordinates of J2000 to equatorial.
+    template<typename ScalarType>
+    auto eclipticToEquatorial(const numutil::Vector3<ScalarType> &ecliptic) -> numutil::Vector3<ScalarType>
+    {
+        auto c = ScalarType(std::cos(obliquityJ2000));
+        auto s = ScalarType(std::sin(obliquityJ2000));
+        return {ecliptic[0], c*ecliptic[1] - s*ecliptic[2], s*ecliptic[1] + c*ecliptic[2]};
+    }
+
+
+    /// Geocentric position of the Sun at t seconds past J2000.
+    template<typename ScalarType>
+    auto sunPosition(double t) -> numutil::Vector3<ScalarType>
+    {
+        const auto degree = std::numbers::pi/180.0;
+        const auto arcsecond = degree/3600.0;
+        auto centuries = t/(36525.0*86400.0);
+        auto m = (357.5256 + 35999.049*centuries)*degree;
+        auto longitude = (282.9400*degree) + m + 6892.0*arcsecond*std::sin(m) + 72.0*arcsecond*std::sin(2.0*m);
+        auto distance = (149.619 - 2.499*std::cos(m) - 0.021*std::cos(2.0*m))*1.0e9;
+        return eclipticToEquatorial(numutil::Vector3<ScalarType>{ScalarType(distance*std::cos(longitude)),
+                                                                 ScalarType(distance*std::sin(longitude)),
+                                                                 ScalarType(0)});
+    }
+
+
+    /// Geocentric position of the Moon at t seconds past J2000.
+    template<typename ScalarType>
+    auto moonPosition(double t) -> numutil::Vector3<ScalarType>
+    {
+        const auto degree = std::numbers::pi/180.0;
+        const auto arcsecond = degree/3600.0;
+        auto T = t/(36525.0*86400.0);
+        // Mean longitude, anomalies of Moon and Sun, argument of latitude and elongation.
+        auto l0 = (218.31617 + 481267.88088*T - 1.3972*T)*degree;
+        auto l = (134.96292 + 477198.86753*T)*degree;
+        auto lp = (357.52543 + 35999.04944*T)*degree;
+        auto f = (93.27283 + 483202.01873*T)*degree;
+        auto d = (297.85027 + 445267.11135*T)*degree;
+
+        auto longitude = l0 + arcsecond*(22640.0*std::sin(l) + 769.0*std::sin(2.0*l) - 4586.0*std::sin(l - 2.0*d)
+                                         + 2370.0*std::sin(2.0*d) - 668.0*std::sin(lp) - 412.0*std::sin(2.0*f)
+                                         - 212.0*std::sin(2.0*l - 2.0*d) - 206.0*std::sin(l + lp - 2.0*d)
+                                         + 192.0*std::sin(l + 2.0*d) - 165.0*std::sin(lp - 2.0*d)
+                                         + 148.0*std::sin(l - lp) - 125.0*std::sin(d) - 110.0*std::sin(l + lp)
+                                         - 55.0*std::sin(2.0*f - 2.0*d));
+        auto latitude = arcsecond*(18520.0*std::sin(f + longitude - l0 + arcsecond*(412.0*std::sin(2.0*f)
+                                                                                    + 541.0*std::sin(lp)))
+                                   - 526.0*std::sin(f - 2.0*d) + 44.0*std::sin(l + f - 2.0*d)
+                                   - 31.0*std::sin(-l + f - 2.0*d) - 25.0*std::sin(-2.0*l + f)
+                                   - 23.0*std::sin(lp + f - 2.0*d) + 21.0*std::sin(-l + f)
+                                   + 11.0*std::sin(-lp + f - 2.0*d));
+        auto distance = (385000.0 - 20905.0*std::cos(l) - 3699.0*std::cos(2.0*d - l) - 2956.0*std::cos(2.0*d)
+                         - 570.0*std::cos(2.0*l) + 246.0*std::cos(2.0*l - 2.0*d) - 205.0*std::cos(lp - 2.0*d)
+                         - 171.0*std::cos(l + 2.0*d) - 152.0*std::cos(l + lp - 2.0*d))*1.0e3;
+
+        return eclipticToEquatorial(numutil::Vector3<ScalarType>{
+                ScalarType(distance*std::cos(longitude)*std::cos(latitude)),
+                ScalarType(distance*std::sin(longitude)*std::cos(latitude)),
+                ScalarType(distance*std::sin(latitude))});
+    }
+
+
+    /**
+     * Sun and Moon positions tabulated at a fixed step over [start, end] and interpolated with four point Lagrange
+     * polynomials.  Built once per integration span; read only afterwards, so one instance serves every object and
+     * thread.  With the default hour step interpolation error is well under a meter, far below the ephemeris error.
+     * @tparam ScalarType float or double.
+     */
+    template<typename ScalarType>
+    class EphemerisCache {
+    public:
+        using vector3 = numutil::Vector3<ScalarType>;
+
+        EphemerisCache(double start, double end, double step = 3600.0);
+
+        auto startTime() const -> double { return start + step; }
+
+        auto endTime() const -> double { return start + step*double(nodes - 2); }
+
+        /// Interpolated Sun position; throws std::out_of_range outside the span.
+        auto sun(double t) const -> vector3 { return interpolate(sunNodes, t); }
+
+        /// Interpolated Moon position; throws std::out_of_range outside the span.
+        auto moon(double t) const -> vector3 { return interpolate(moonNodes, t); }
+
+    private:
+        auto interpolate(const std::vector<vector3> &table, double t) const -> vector3;
+
+        double start;
+        double step;
+        std::size_t nodes;
+        std::vector<vector3> sunNodes;
+        std::vector<vector3> moonNodes;
+    };
+
+
+    template<typename ScalarType>
+    EphemerisCache<ScalarType>::EphemerisCache(double start0, double end, double step0)
+            : start{start0 - step0}, step{step0},
+              nodes{static_cast<std::size_t>(std::ceil((end - start0)/step0)) + 3}
+    {
+        if (!(end >= start0) || !(step > 0)) throw std::invalid_argument{"ephemeris span"};
+        // One node before the start and two past the end keep every interval inside the four point stencil.
+        sunNodes.reserve(nodes);
+        moonNodes.reserve(nodes);
+        for (auto k = 0u; k < nodes; ++k) {
+            auto t = start + step*double(k);
+            auto sun = sunPosition<double>(t);
+            auto moon = moonPosition<double>(t);
+            sunNodes.push_back({ScalarType(sun[0]), ScalarType(sun[1]), ScalarType(sun[2])});
+            moonNodes.push_back({ScalarType(moon[0]), ScalarType(moon[1]), ScalarType(moon[2])});
+        }
+    }
+
+
+    template<typename ScalarType>
+    auto EphemerisCache<ScalarType>::interpolate(const std::vector<vector3> &table, double t) const -> vector3
+    {
+        auto x = (t - start)/step;
+        if (!(x >= 1.0) || !(x <= double(nodes - 2))) throw std::out_of_range{"time outside ephemeris span"};
+        auto k = std::min(static_cast<std::size_t>(x), nodes - 3);
+        auto p = ScalarType(x - double(k));
+
+        // Lagrange weights on nodes k-1, k, k+1, k+2 at offset p from node k.
+        auto w0 = -p*(p - 1)*(p - 2)/6;
+        auto w1 = (p + 1)*(p - 1)*(p - 2)/2;
+        auto w2 = -(p + 1)*p*(p - 2)/2;
+        auto w3 = (p + 1)*p*(p - 1)/6;
+        return table[k - 1]*w0 + table[k]*w1 + table[k + 1]*w2 + table[k + 2]*w3;
+    }
+}
+
+#endif //ORBIT_EPHEMERIS_HPP
+#pragma clang diagnostic pop
@@ -0,0 +1,525 @@
+// -*- mode: c++ -*-
+////
+// Extended and unscented Kalman filters over a StateVector for incremental tracking updates.  Filter state is a
+// fixed size value so banks of filters live in flat arrays and update without allocating.
+//
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedStructInspection"
+#pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
+
+#ifndef ORBIT_FILTER_HPP
+#define ORBIT_FILTER_HPP
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include "orbit.hpp"
+#include "parallel.hpp"
+#include "propagator.hpp"
+#include "vector3.hpp"
+
+namespace orbit {
+    /// Estimate of one tracked object: state at time with its covariance.
+    template<typename ScalarType>
+    struct FilterState {
+        ScalarType time = 0;
+        StateVector<ScalarType> state;
+        Matrix6x6<ScalarType> covariance{};
+    };
+
+
+    /// Inertial position of the object.
+    template<typename ScalarType>
+    struct PositionMeasurement {
+        static const auto dimension = 3;
+        using vectorType = std::array<ScalarType, dimension>;
+        using jacobianType = std::array<std::array<ScalarType, 6>, dimension>;
+
+        ScalarType time;
+        numutil::Vector3<ScalarType> position;
+        ScalarType sigma = 1;
+
+        auto observed() const -> vectorType { return {position[0], position[1], position[2]}; }
+
+        auto predict(const StateVector<ScalarType> &s) const -> vectorType { return {s.r[0], s.r[1], s.r[2]}; }
+
+        auto jacobian(const StateVector<ScalarType> &, jacobianType &h) const -> void
+        {
+            for (auto i = 0; i < dimension; ++i) {
+                h[i].fill(0);
+                h[i][i] = 1;
+            }
+        }
+    };
+
+
+    /// Distance from a station at a known inertial position.
+    template<typename ScalarType>
+    struct RangeMeasurement {
+        static const auto dimension = 1;
+        using vectorType = std::array<ScalarType, dimension>;
+        using jacobianType = std::array<std::array<ScalarType, 6>, dimension>;
+
+        ScalarType time;
+        numutil::Vector3<ScalarType> station;
+        ScalarType range;
+        ScalarType sigma = 1;
+
+        auto observed() const -> vectorType { return {range}; }
+
+        auto predict(const StateVector<ScalarType> &s) const -> vectorType { return {(s.r - station).norm()}; }
+
+        auto jacobian(const StateVector<ScalarType> &s, jacobianType &h) const -> void
+        {
+            auto lineOfSight = (s.r - station).unit();
+            for (auto j = 0; j < 3; ++j) {
+                h[0][j] = lineOfSight[j];
+                h[0][j + 3] = 0;
+            }
+        }
+    };
+
+
+    /// Rate of change of distance from a station with a known inertial position and velocity.
+    template<typename ScalarType>
+    struct RangeRateMeasurement {
+        static const auto dimension = 1;
+        using vectorType = std::array<ScalarType, dimension>;
+        using jacobianType = std::array<std::array<ScalarType, 6>, dimension>;
+
+        ScalarType time;
+        numutil::Vector3<ScalarType> station;
+        numutil::Vector3<ScalarType> stationVelocity;
+        ScalarType rangeRate;
+        ScalarType sigma = 1;
+
+        auto observed() const -> vectorType { return {rangeRate}; }
+
+        auto predict(const StateVector<ScalarType> &s) const -> vectorType
+        {
+            auto relative = s.r - station;
+            return {relative.dot(s.v - stationVelocity)/relative.norm()};
+        }
+
+        auto jacobian(const StateVector<ScalarType> &s, jacobianType &h) const -> void
+        {
+            auto relative = s.r - station;
+            auto relativeVelocity = s.v - stationVelocity;
+            auto range = relative.norm();
+            auto rate = relative.dot(relativeVelocity)/range;
+            for (auto j = 0; j < 3; ++j) {
+                h[0][j] = (relativeVelocity[j] - rate*relative[j]/range)/range;
+                h[0][j + 3] = relative[j]/range;
+            }
+        }
+    };
+
+
+    /**
+     * Solve a*x = b for x in place of b, a symmetric positive definite, by Cholesky factorization in place of a.
+     * @return false if a is not positive definite.
+     */
+    template<typename ScalarType, std::size_t n, std::size_t columns>
+    auto choleskySolve(std::array<std::array<ScalarType, n>, n> &a,
+                       std::array<std::array<ScalarType, columns>, n> &b) -> bool
+    {
+        for (auto j = 0u; j < n; ++j) {
+            auto diagonal = a[j][j];
+            for (auto k = 0u; k < j; ++k) diagonal -= a[j][k]*a[j][k];
+            if (!(diagonal > 0)) return false;
+            a[j][j] = std::sqrt(diagonal);
+            for (auto i = j + 1; i < n; ++i) {
+                auto sum = a[i][j];
+                for (auto k = 0u; k < j; ++k) sum -= a[i][k]*a[j][k];
+                a[i][j] = sum/a[j][j];
+            }
+        }
+        for (auto c = 0u; c < columns; ++c) {
+            for (auto i = 0u; i < n; ++i) {
+                for (auto k = 0u; k < i; ++k) b[i][c] -= a[i][k]*b[k][c];
+                b[i][c] /= a[i][i];
+            }
+            for (auto i = n; i-- > 0;) {
+                for (auto k = i + 1; k < n; ++k) b[i][c] -= a[k][i]*b[k][c];
+                b[i][c] /= a[i][i];
+            }
+        }
+        return true;
+    }
+
+
+    /**
+     * Continuous white noise acceleration process noise over dt for spectral density q (m^2/s^3), added to p.
+     */
+    template<typename ScalarType>
+    auto addProcessNoise(Matrix6x6<ScalarType> &p, ScalarType q, ScalarType dt) -> void
+    {
+        auto dt2 = dt*dt;
+        for (auto i = 0; i < 3; ++i) {
+            p[i][i] += q*dt2*std::abs(dt)/3;
+            p[i][i + 3] += q*dt2/2;
+            p[i + 3][i] += q*dt2/2;
+            p[i + 3][i + 3] += q*std::abs(dt);
+        }
+    }
+
+
+    /**
+     * Extended Kalman filter.  The process model supplies propagate(state, dt, stm) such as KeplerPropagator or
+     * J2Propagator; measurements supply observed(), predict(state) and jacobian(state, h).
+     * @tparam ScalarType float or double.
+     * @tparam Process Propagator used for the time update.
+     */
+    template<typename ScalarType, typename Process = KeplerPropagator<ScalarType>>
+    class ExtendedKalmanFilter {
+    public:
+        using stateType = FilterState<ScalarType>;
+
+        explicit ExtendedKalmanFilter(Process process0 = Process{}, ScalarType accelerationNoise0 = 0)
+                : process{process0}, accelerationNoise{accelerationNoise0} {}
+
+        /// Advance the estimate to time.
+        auto predict(stateType &, ScalarType time) const -> void;
+
+        /// Advance the estimate to the measurement time and incorporate it.
+        /// \return Normalized innovation squared, for gating and consistency checks; negative if rejected.
+        template<typename Measurement>
+        auto update(stateType &, const Measurement &) const -> ScalarType;
+
+    private:
+        Process process;
+        ScalarType accelerationNoise;
+    };
+
+
+    template<typename ScalarType, typename Process>
+    auto ExtendedKalmanFilter<ScalarType, Process>::predict(stateType &filter, ScalarType time) const -> void
+    {
+        auto dt = time - filter.time;
+        if (dt == 0) return;
+
+        Matrix6x6<ScalarType> stm;
+        filter.state = process.propagate(filter.state, dt, stm);
+        filter.time = time;
+
+        // P = Phi P Phi^T
+        Matrix6x6<ScalarType> product;
+        for (auto i = 0; i < 6; ++i) {
+            for (auto j = 0; j < 6; ++j) {
+                ScalarType sum = 0;
+                for (auto k = 0; k < 6; ++k) sum += stm[i][k]*filter.covariance[k][j];
+                product[i][j] = sum;
+            }
+        }
+        for (auto i = 0; i < 6; ++i) {
+            for (auto j = 0; j < 6; ++j) {
+                ScalarType sum = 0;
+                for (auto k = 0; k < 6; ++k) sum += product[i][k]*stm[j][k];
+                filter.covariance[i][j] = sum;
+            }
+        }
+        addProcessNoise(filter.covariance, accelerationNoise, dt);
+    }
+
+
+    template<typename ScalarType, typename Process>
+    template<typename Measurement>
+    auto ExtendedKalmanFilter<ScalarType, Process>::update(stateType &filter, const Measurement &measurement) const
+    -> ScalarType
+    {
+        static const auto m = Measurement::dimension;
+        predict(filter, measurement.time);
+
+        typename Measurement::jacobianType h;
+        measurement.jacobian(filter.state, h);
+        auto predicted = measurement.predict(filter.state);
+        auto observed = measurement.observed();
+        auto variance = measurement.sigma*measurement.sigma;
+
+        // PH^T (6 x m) and innovation covariance S = H P H^T + R (m x m).
+        std::array<std::array<ScalarType, m>, 6> pht;
+        for (auto i = 0; i < 6; ++i) {
+            for (auto j = 0; j < m; ++j) {
+                ScalarType sum = 0;
+                for (auto k = 0; k < 6; ++k) sum += filter.covariance[i][k]*h[j][k];
+                pht[i][j] = sum;
+            }
+        }
+        std::array<std::array<ScalarType, m>, m> innovationCovariance;
+        for (auto i = 0; i < m; ++i) {
+            for (auto j = 0; j < m; ++j) {
+                ScalarType sum = 0;
+                for (auto k = 0; k < 6; ++k) sum += h[i][k]*pht[k][j];
+                innovationCovariance[i][j] = sum + (i == j ? variance : 0);
+            }
+        }
+
+        // Solve S [K^T | S^-1 y] = [H P | y] together.
+        std::array<std::array<ScalarType, 7>, m> solution;
+        for (auto i = 0; i < m; ++i) {
+            for (auto j = 0; j < 6; ++j) solution[i][j] = pht[j][i];
+            solution[i][6] = observed[i] - predicted[i];
+        }
+        if (!choleskySolve(innovationCovariance, solution)) return -1;
+
+        ScalarType nis = 0;
+        for (auto i = 0; i < m; ++i) nis += (observed[i] - predicted[i])*solution[i][6];
+
+        // x += K y
+        for (auto i = 0; i < 3; ++i) {
+            ScalarType dr = 0, dv = 0;
+            for (auto k = 0; k < m; ++k) {
+                dr += solution[k][i]*(observed[k] - predicted[k]);
+                dv += solution[k][i + 3]*(observed[k] - predicted[k]);
+            }
+            filter.state.r[i] += dr;
+            filter.state.v[i] += dv;
+        }
+
+        // Joseph form P = (I - KH) P (I - KH)^T + K R K^T keeps P symmetric positive definite.
+        Matrix6x6<ScalarType> a;
+        for (auto i = 0; i < 6; ++i) {
+            for (auto j = 0; j < 6; ++j) {
+                ScalarType sum = i == j ? 1 : 0;
+                for (auto k = 0; k < m; ++k) sum -= solution[k][i]*h[k][j];
+                a[i][j] = sum;
+            }
+        }
+        Matrix6x6<ScalarType> product;
+        for (auto i = 0; i < 6; ++i) {
+            for (auto j = 0; j < 6; ++j) {
+                ScalarType sum = 0;
+                for (auto k = 0; k < 6; ++k) sum += a[i][k]*filter.covariance[k][j];
+                product[i][j] = sum;
+            }
+        }
+        for (auto i = 0; i < 6; ++i) {
+            for (auto j = 0; j < 6; ++j) {
+                ScalarType sum = 0;
+                for (auto k = 0; k < 6; ++k) sum += product[i][k]*a[j][k];
+                for (auto k = 0; k < m; ++k) sum += solution[k][i]*variance*solution[k][j];
+                filter.covariance[i][j] = sum;
+            }
+        }
+        return nis;
+    }
+
+
+    /**
+     * Unscented Kalman filter with the scaled sigma point set of 2n + 1 points.  Needs only propagate(state, dt)
+     * from the process model and predict(state) from measurements, so no partial derivatives.
+     * @tparam ScalarType float or double.
+     * @tparam Process Propagator used for the time update.
+     */
+    template<typename ScalarType, typename Process = KeplerPropagator<ScalarType>>
+    class UnscentedKalmanFilter {
+    public:
+        using stateType = FilterState<ScalarType>;
+        static const auto sigmaPoints = 13;
+
+        explicit UnscentedKalmanFilter(Process process0 = Process{}, ScalarType accelerationNoise0 = 0,
+                                       ScalarType alpha = 1, ScalarType beta = 2, ScalarType kappa = 0);
+
+        /// Advance the estimate to time.
+        /// \return false if the covariance has lost positive definiteness.
+        auto predict(stateType &, ScalarType time) const -> bool;
+
+        /// Advance the estimate to the measurement time and incorporate it.
+        /// \return Normalized innovation squared; negative if rejected.
+        template<typename Measurement>
+        auto update(stateType &, const Measurement &) const -> ScalarType;
+
+    private:
+        /// Sigma points about the current estimate, false if the covariance is not positive definite.
+        auto generate(const stateType &, std::array<StateVector<ScalarType>, sigmaPoints> &) const -> bool;
+
+        Process process;
+        ScalarType accelerationNoise;
+        ScalarType spread;          // sqrt(n + lambda)
+        ScalarType meanWeight0, covarianceWeight0, weight;
+    };
+
+
+    template<typename ScalarType, typename Process>
+    UnscentedKalmanFilter<ScalarType, Process>::UnscentedKalmanFilter(Process process0, ScalarType accelerationNoise0,
+                                                                      ScalarType alpha, ScalarType beta,
+                                                                      ScalarType kappa)
+            : process{process0}, accelerationNoise{accelerationNoise0}
+    {
+        const ScalarType n = 6;
+        auto lambda = alpha*alpha*(n + kappa) - n;
+        spread = std::sqrt(n + lambda);
+        meanWeight0 = lambda/(n + lambda);
+        covarianceWeight0 = meanWeight0 + 1 - alpha*alpha + beta;
+        weight = 1/(2*(n + lambda));
+    }
+
+
+    template<typename ScalarType, typename Process>
+    auto UnscentedKalmanFilter<ScalarType, Process>::generate(const stateType &filter,
+                                                              std::array<StateVector<ScalarType>, sigmaPoints> &points)
+                                                              const -> bool
+    {
+        // Lower Cholesky factor L of P; sigma points are x +- spread*L columns.
+        Matrix6x6<ScalarType> l{};
+        for (auto j = 0; j < 6; ++j) {
+            auto diagonal = filter.covariance[j][j];
+            for (auto k = 0; k < j; ++k) diagonal -= l[j][k]*l[j][k];
+            if (!(diagonal > 0)) return false;
+            l[j][j] = std::sqrt(diagonal);
+            for (auto i = j + 1; i < 6; ++i) {
+                auto sum = filter.covariance[i][j];
+                for (auto k = 0; k < j; ++k) sum -= l[i][k]*l[j][k];
+                l[i][j] = sum/l[j][j];
+            }
+        }
+
+        points[0] = filter.state;
+        for (auto j = 0; j < 6; ++j) {
+            points[j + 1] = filter.state;
+            points[j + 7] = filter.state;
+            for (auto i = 0; i < 3; ++i) {
+                points[j + 1].r[i] += spread*l[i][j];
+                points[j + 1].v[i] += spread*l[i + 3][j];
+                points[j + 7].r[i] -= spread*l[i][j];
+                points[j + 7].v[i] -= spread*l[i + 3][j];
+            }
+        }
+        return true;
+    }
+
+
+    template<typename ScalarType, typename Process>
+    auto UnscentedKalmanFilter<ScalarType, Process>::predict(stateType &filter, ScalarType time) const -> bool
+    {
+        auto dt = time - filter.time;
+        if (dt == 0) return true;
+
+        std::array<StateVector<ScalarType>, sigmaPoints> points;
+        if (!generate(filter, points)) return false;
+        for (auto &point: points) point = process.propagate(point, dt);
+
+        // Deviations are taken from the central point so the weighted sums do not lose precision to the
+        // magnitude of the position.
+        std::array<ScalarType, 6> mean{};
+        for (auto p = 1; p < sigmaPoints; ++p) {
+            for (auto i = 0; i < 3; ++i) {
+                mean[i] += weight*(points[p].r[i] - points[0].r[i]);
+                mean[i + 3] += weight*(points[p].v[i] - points[0].v[i]);
+            }
+        }
+        for (auto &row: filter.covariance) row.fill(0);
+        for (auto p = 0; p < sigmaPoints; ++p) {
+            std::array<ScalarType, 6> d;
+            for (auto i = 0; i < 3; ++i) {
+                d[i] = points[p].r[i] - points[0].r[i] - mean[i];
+                d[i + 3] = points[p].v[i] - points[0].v[i] - mean[i + 3];
+            }
+            auto w = p == 0 ? covarianceWeight0 : weight;
+            for (auto i = 0; i < 6; ++i) {
+                for (auto j = 0; j < 6; ++j) filter.covariance[i][j] += w*d[i]*d[j];
+            }
+        }
+        filter.state = points[0];
+        for (auto i = 0; i < 3; ++i) {
+            filter.state.r[i] += mean[i];
+            filter.state.v[i] += mean[i + 3];
+        }
+        filter.time = time;
+        addProcessNoise(filter.covariance, accelerationNoise, dt);
+        return true;
+    }
+
+
+    template<typename ScalarType, typename Process>
+    template<typename Measurement>
+    auto UnscentedKalmanFilter<ScalarType, Process>::update(stateType &filter, const Measurement &measurement) const
+    -> ScalarType
+    {
+        static const auto m = Measurement::dimension;
+        if (!predict(filter, measurement.time)) return -1;
+
+        std::array<StateVector<ScalarType>, sigmaPoints> points;
+        if (!generate(filter, points)) return -1;
+        std::array<typename Measurement::vectorType, sigmaPoints> z;
+        for (auto p = 0; p < sigmaPoints; ++p) z[p] = measurement.predict(points[p]);
+
+        typename Measurement::vectorType zMean{};
+        for (auto p = 1; p < sigmaPoints; ++p) {
+            for (auto i = 0; i < m; ++i) zMean[i] += weight*(z[p][i] - z[0][i]);
+        }
+
+        // Pzz + R, and Pxz stored transposed as the right hand side for the gain.
+        std::array<std::array<ScalarType, m>, m> innovationCovariance{};
+        std::array<std::array<ScalarType, 7>, m> solution{};
+        for (auto p = 0; p < sigmaPoints; ++p) {
+            auto w = p == 0 ? covarianceWeight0 : weight;
+            std::array<ScalarType, 6> dx;
+            for (auto i = 0; i < 3; ++i) {
+                dx[i] = points[p].r[i] - filter.state.r[i];
+                dx[i + 3] = points[p].v[i] - filter.state.v[i];
+            }
+            for (auto i = 0; i < m; ++i) {
+                auto dzi = z[p][i] - z[0][i] - zMean[i];
+                for (auto j = 0; j < m; ++j) innovationCovariance[i][j] += w*dzi*(z[p][j] - z[0][j] - zMean[j]);
+                for (auto j = 0; j < 6; ++j) solution[i][j] += w*dzi*dx[j];
+            }
+        }
+        auto variance = measurement.sigma*measurement.sigma;
+        auto observed = measurement.observed();
+        std::array<ScalarType, m> innovation;
+        for (auto i = 0; i < m; ++i) {
+            innovationCovariance[i][i] += variance;
+            innovation[i] = observed[i] - z[0][i] - zMean[i];
+            solution[i][6] = innovation[i];
+        }
+
+        // Keep Pzz for P -= K Pzz K^T before it is factored.
+        auto pzz = innovationCovariance;
+        if (!choleskySolve(innovationCovariance, solution)) return -1;
+
+        ScalarType nis = 0;
+        for (auto i = 0; i < m; ++i) nis += innovation[i]*solution[i][6];
+        for (auto i = 0; i < 3; ++i) {
+            for (auto k = 0; k < m; ++k) {
+                filter.state.r[i] += solution[k][i]*innovation[k];
+                filter.state.v[i] += solution[k][i + 3]*innovation[k];
+            }
+        }
+        for (auto i = 0; i < 6; ++i) {
+            for (auto j = 0; j < 6; ++j) {
+                ScalarType sum = 0;
+                for (auto a = 0; a < m; ++a) {
+                    for (auto b = 0; b < m; ++b) sum += solution[a][i]*pzz[a][b]*solution[b][j];
+                }
+                filter.covariance[i][j] -= sum;
+            }
+        }
+        return nis;
+    }
+
+
+    /**
+     * Apply measurements[k] to filters[k] for every k on a pool of threads, in chunks of 64 updates so a small
+     * batch runs on the calling thread instead of paying for starting threads.
+     * @param filter ExtendedKalmanFilter or UnscentedKalmanFilter shared read-only by all workers.
+     * @param nis If not empty, receives each update's normalized innovation squared.
+     */
+    template<typename Filter, typename ScalarType, typename Measurement>
+    auto updateFilters(const Filter &filter, std::span<FilterState<ScalarType>> states,
+                       std::span<const Measurement> measurements, std::span<ScalarType> nis = {},
+                       unsigned workers = 0) -> void
+    {
+        numutil::parallelFor(states.size(), [&](std::size_t begin, std::size_t end, unsigned) {
+            for (auto k = begin; k < end; ++k) {
+                auto result = filter.update(states[k], measurements[k]);
+                if (!nis.empty()) nis[k] = result;
+            }
+        }, workers, 64);
+    }
+}
+
+#endif //ORBIT_FILTER_HPP
+#pragma clang diagnostic pop
@@ -0,0 +1,299 @@
+// -*- mode: c++ -*-
+////
+// Spherical harmonic gravity field in the nonsingular formulation of Pines (1973) using fully normalized derived
+// Legendre functions, so it is well behaved at the poles and to high degree.  Positions are body fixed.
+//
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedStructInspection"
+#pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
+
+#ifndef ORBIT_GRAVITY_HPP
+#define ORBIT_GRAVITY_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "constants.hpp"
+#include "vector3.hpp"
+
+namespace orbit {
+    /**
+     * Per thread scratch storage for GravityField evaluations.  Sized once for a maximum degree and reused for every
+     * call, so evaluating the field never allocates.
+     */
+    template<typename ScalarType>
+    class GravityWorkspace {
+    public:
+        explicit GravityWorkspace(int maxDegree = 0) { resize(maxDegree); }
+
+        auto degree() const -> int { return capacity; }
+
+        auto resize(int maxDegree) -> void
+        {
+            capacity = maxDegree;
+            legendre.assign(static_cast<std::size_t>(maxDegree + 2)*(maxDegree + 3)/2, 0);
+            real.assign(maxDegree + 2, 0);
+            imaginary.assign(maxDegree + 2, 0);
+        }
+
+    private:
+        template<typename> friend class GravityField;
+
+        int capacity = 0;
+        std::vector<ScalarType> legendre;   // normalized derived Legendre functions, row n holds m = 0..n
+        std::vector<ScalarType> real;       // Re (s + i t)^m
+        std::vector<ScalarType> imaginary;  // Im (s + i t)^m
+    };
+
+
+    /**
+     * Gravity field from fully normalized Stokes coefficients C_nm, S_nm.
+     * The recursion factors for the Legendre functions depend only on n and m and are computed once when the field
+     * is built.  Evaluations take a degree argument to truncate the expansion for speed.
+     * @tparam ScalarType float or double.
+     */
+    template<typename ScalarType>
+    class GravityField {
+    public:
+        using vector3 = numutil::Vector3<ScalarType>;
+
+        /// Field of the given degree and order with all coefficients zero except C_00 = 1 (a point mass).
+        GravityField(int maxDegree, ScalarType mu0, ScalarType radius0);
+
+        /**
+         * Load coefficients from an ICGEM .gfc file or a plain table of "n m C S ..." lines.
+         * ICGEM header values earth_gravity_constant and radius override mu0 and radius0.
+         * Coefficients above maxDegree are skipped.  Throws std::runtime_error if the file cannot be read.
+         */
+        static auto load(const std::string &path, int maxDegree, ScalarType mu0 = ScalarType(muEarthEGM),
+                         ScalarType radius0 = ScalarType(earthRadiusEGM)) -> GravityField;
+
+        auto degree() const -> int { return maxDegree; }
+
+        auto gravitationalConstant() const { return mu; }
+
+        auto referenceRadius() const { return radius; }
+
+        /// Normalized C_nm.
+        auto c(int n, int m) const -> ScalarType { return cosine[index(n, m)]; }
+
+        /// Normalized S_nm.
+        auto s(int n, int m) const -> ScalarType { return sine[index(n, m)]; }
+
+        auto setCoefficients(int n, int m, ScalarType cnm, ScalarType snm) -> void;
+
+        /// Acceleration at body fixed position r using terms through degree (and order) degree, -1 for all.
+        auto acceleration(const vector3 &r, GravityWorkspace<ScalarType> &workspace, int degree = -1) const -> vector3;
+
+        /// Gravitational potential at r, positive outward convention U = mu/r + ...
+        auto potential(const vector3 &r, GravityWorkspace<ScalarType> &workspace, int degree = -1) const -> ScalarType;
+
+    private:
+        static auto index(int n, int m) -> std::size_t { return static_cast<std::size_t>(n)*(n + 1)/2 + m; }
+
+        /// Fill the workspace with Legendre functions through degree n = degree and order m <= n + 1.
+        auto recurse(ScalarType u, ScalarType s, ScalarType t, GravityWorkspace<ScalarType> &, int degree) const
+        -> void;
+
+        int maxDegree;
+        ScalarType mu;
+        ScalarType radius;
+        std::vector<ScalarType> cosine;
+        std::vector<ScalarType> sine;
+
+        // Cached recursion factors, indexed like the Legendre functions out to degree maxDegree + 1.
+        std::vector<ScalarType> sectoral;   // A_nn = sectoral[n] A_(n-1)(n-1)
+        std::vector<ScalarType> first;      // A_nm = first[nm] u A_(n-1)m - second[nm] A_(n-2)m
+        std::vector<ScalarType> second;
+        std::vector<ScalarType> raise;      // C_nm A_n(m+1) in normalized terms carries factor raise[nm]
+    };
+
+
+    template<typename ScalarType>
+    GravityField<ScalarType>::GravityField(int maxDegree0, ScalarType mu0, ScalarType radius0)
+            : maxDegree{maxDegree0}, mu{mu0}, radius{radius0},
+              cosine(index(maxDegree0 + 1, 0), 0), sine(index(maxDegree0 + 1, 0), 0),
+              sectoral(maxDegree0 + 2, 0), first(index(maxDegree0 + 2, 0), 0), second(index(maxDegree0 + 2, 0), 0),
+              raise(index(maxDegree0 + 1, 0), 0)
+    {
+        cosine[0] = 1;
+        // With Pi_nm = sqrt((n+m)!/((2 - delta_m0)(2n+1)(n-m)!)) and normalized A_nm = A_nm/Pi_nm, Pines'
+        // recursions A_nn = (2n-1) A_(n-1)(n-1) and (n-m) A_nm = (2n-1) u A_(n-1)m - (n+m-1) A_(n-2)m become the
+        // factors below.
+        for (auto n = 1; n <= maxDegree + 1; ++n) {
+            sectoral[n] = std::sqrt(ScalarType(n == 1 ? 2 : 1)*ScalarType(2*n + 1)/ScalarType(2*n));
+        }
+        for (auto n = 1; n <= maxDegree + 1; ++n) {
+            for (auto m = 0; m < n; ++m) {
+                auto nm = index(n, m);
+                double dn = n, dm = m;
+                first[nm] = ScalarType(std::sqrt((2*dn - 1)*(2*dn + 1)/((dn - dm)*(dn + dm))));
+                second[nm] = n - m >= 2 ? ScalarType(std::sqrt((2*dn + 1)*(dn - dm - 1)*(dn + dm - 1)
+                                                               /((2*dn - 3)*(dn - dm)*(dn + dm)))) : ScalarType(0);
+            }
+        }
+        for (auto n = 0; n <= maxDegree; ++n) {
+            for (auto m = 0; m <= n; ++m) {
+                double dn = n, dm = m;
+                raise[index(n, m)] = ScalarType(std::sqrt((dn + dm + 1)*(dn - dm)*(m == 0 ? 0.5 : 1.0)));
+            }
+        }
+    }
+
+
+    template<typename ScalarType>
+    auto GravityField<ScalarType>::load(const std::string &path, int maxDegree, ScalarType mu0, ScalarType radius0)
+    -> GravityField
+    {
+        std::ifstream in{path};
+        if (!in) throw std::runtime_error{"cannot open gravity field " + path};
+
+        GravityField field{maxDegree, mu0, radius0};
+        auto loaded = 0;
+        for (std::string text; std::getline(in, text);) {
+            // Fortran style exponents, 1.0D-06, appear in the EGM distributions.
+            for (auto k = 1u; k < text.size(); ++k) {
+                auto previous = static_cast<unsigned char>(text[k - 1]);
+                auto exponent = text[k] == 'D' || text[k] == 'd';
+                if (exponent && (std::isdigit(previous) || previous == '.')) text[k] = 'E';
+            }
+            std::istringstream fields{text};
+
+            // Coefficient lines may carry a leading keyword ("gfc"); header lines never parse as n m C S.
+            if (!text.empty() && std::isalpha(static_cast<unsigned char>(text.front()))) {
+                std::string key;
+                fields >> key;
+                double value;
+                if (key == "earth_gravity_constant" && fields >> value) field.mu = ScalarType(value);
+                if (key == "radius" && fields >> value) field.radius = ScalarType(value);
+            }
+            int n, m;
+            double cnm, snm;
+            if (!(fields >> n >> m >> cnm >> snm)) continue;
+            if (n < 0 || m < 0 || m > n) throw std::runtime_error{"bad degree or order in " + path};
+            if (n > maxDegree) continue;
+            field.setCoefficients(n, m, ScalarType(cnm), ScalarType(snm));
+            ++loaded;
+        }
+        if (loaded == 0) throw std::runtime_error{"no coefficients in " + path};
+        return field;
+    }
+
+
+    template<typename ScalarType>
+    auto GravityField<ScalarType>::setCoefficients(int n, int m, ScalarType cnm, ScalarType snm) -> void
+    {
+        if (n < 0 || n > maxDegree || m < 0 || m > n) throw std::out_of_range{"gravity coefficient index"};
+        cosine[index(n, m)] = cnm;
+        sine[index(n, m)] = snm;
+    }
+
+
+    template<typename ScalarType>
+    auto GravityField<ScalarType>::recurse(ScalarType u, ScalarType s, ScalarType t,
+                                           GravityWorkspace<ScalarType> &w, int degree) const -> void
+    {
+        auto *a = w.legendre.data();
+        a[0] = 1;
+        for (auto n = 1; n <= degree + 1; ++n) {
+            a[index(n, n)] = sectoral[n]*a[index(n - 1, n - 1)];
+            for (auto m = 0; m < n; ++m) {
+                auto nm = index(n, m);
+                a[nm] = first[nm]*u*a[index(n - 1, m)];
+                if (n - m >= 2) a[nm] -= second[nm]*a[index(n - 2, m)];
+            }
+        }
+
+        w.real[0] = 1;
+        w.imaginary[0] = 0;
+        for (auto m = 1; m <= degree + 1; ++m) {
+            w.real[m] = s*w.real[m - 1] - t*w.imaginary[m - 1];
+            w.imaginary[m] = s*w.imaginary[m - 1] + t*w.real[m - 1];
+        }
+    }
+
+
+    template<typename ScalarType>
+    auto GravityField<ScalarType>::acceleration(const vector3 &r, GravityWorkspace<ScalarType> &w, int degree) const
+    -> vector3
+    {
+        if (degree < 0 || degree > maxDegree) degree = maxDegree;
+        if (w.degree() < degree) w.resize(degree);
+
+        auto rNorm = r.norm();
+        auto s = r[0]/rNorm;
+        auto t = r[1]/rNorm;
+        auto u = r[2]/rNorm;
+        recurse(u, s, t, w, degree);
+        const auto *a = w.legendre.data();
+
+        // For each term f = mu R^n A_nm(u) D_nm(s, t)/r^(n+1) with D_nm = C_nm Re(s+it)^m + S_nm Im(s+it)^m:
+        //   a = rho (m A_nm E_nm, m A_nm F_nm, A_n(m+1) D_nm) - rho D_nm ((n+m+1) A_nm + u A_n(m+1)) (s, t, u)
+        // where rho = mu R^n/r^(n+2), E_nm = dD_nm/ds/m and F_nm = dD_nm/dt/m.
+        ScalarType a1 = 0, a2 = 0, a3 = 0, a4 = 0;
+        auto ratio = radius/rNorm;
+        auto rho = mu/(rNorm*rNorm);
+        for (auto n = 0; n <= degree; ++n) {
+            ScalarType sum1 = 0, sum2 = 0, sum3 = 0, sum4 = 0;
+            for (auto m = 0; m <= n; ++m) {
+                auto nm = index(n, m);
+                auto cnm = cosine[nm];
+                auto snm = sine[nm];
+                auto d = cnm*w.real[m] + snm*w.imaginary[m];
+                auto anm = a[nm];
+                // raise[nn] is zero, so the m = n term reads A_(n+1)0 harmlessly in place of A_n(n+1) = 0.
+                auto raised = raise[nm]*a[index(n, m + 1)];
+                if (m > 0) {
+                    auto e = cnm*w.real[m - 1] + snm*w.imaginary[m - 1];
+                    auto f = snm*w.real[m - 1] - cnm*w.imaginary[m - 1];
+                    sum1 += ScalarType(m)*anm*e;
+                    sum2 += ScalarType(m)*anm*f;
+                }
+                sum3 += raised*d;
+                sum4 += d*(ScalarType(n + m + 1)*anm + u*raised);
+            }
+            a1 += rho*sum1;
+            a2 += rho*sum2;
+            a3 += rho*sum3;
+            a4 -= rho*sum4;
+            rho *= ratio;
+        }
+        return {a1 + a4*s, a2 + a4*t, a3 + a4*u};
+    }
+
+
+    template<typename ScalarType>
+    auto GravityField<ScalarType>::potential(const vector3 &r, GravityWorkspace<ScalarType> &w, int degree) const
+    -> ScalarType
+    {
+        if (degree < 0 || degree > maxDegree) degree = maxDegree;
+        if (w.degree() < degree) w.resize(degree);
+
+        auto rNorm = r.norm();
+        recurse(r[2]/rNorm, r[0]/rNorm, r[1]/rNorm, w, degree);
+        const auto *a = w.legendre.data();
+
+        ScalarType result = 0;
+        auto ratio = radius/rNorm;
+        auto scale = mu/rNorm;
+        for (auto n = 0; n <= degree; ++n) {
+            ScalarType sum = 0;
+            for (auto m = 0; m <= n; ++m) {
+                auto nm = index(n, m);
+                sum += a[nm]*(cosine[nm]*w.real[m] + sine[nm]*w.imaginary[m]);
+            }
+            result += scale*sum;
+            scale *= ratio;
+        }
+        return result;
+    }
+}
+
+#endif //ORBIT_GRAVITY_HPP
+#pragma clang diagnostic pop
@@ -0,0 +1,120 @@
+// -*- mode: c++ -*-
+////
+// Opt-in counters for the conversion and propagation entry points: call counts, latency histograms, Kepler iteration
+// histograms and non-finite results.  Configure with -DORBIT_INSTRUMENTATION=ON to turn the probes on; otherwise the
+// ORBIT_PROBE family of macros expands to nothing and the hot paths carry no cost.
+//
+// Each thread writes only its own counters, so recording takes no locks or atomic read-modify-write.  snapshot()
+// sums every live thread plus the totals of threads that have exited, less the totals taken at the last reset.
+//
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
+
+#ifndef ORBIT_INSTRUMENTATION_HPP
+#define ORBIT_INSTRUMENTATION_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace orbit::instrumentation {
+    /// Instrumented entry points.
+    enum class Probe : int {
+        stateFromElements,  // StateVector(const KeplerianElements&)
+        elementsFromState,  // KeplerianElements(const StateVector&)
+        keplerPropagate,    // KeplerPropagator::propagate
+        keplerPartials,     // KeplerPropagator::propagate with state transition matrix
+        j2Propagate,        // J2Propagator::propagate
+        j2Partials,         // J2Propagator::propagate with state transition matrix
+        count
+    };
+
+    static const auto probeCount = static_cast<int>(Probe::count);
+
+    /// Latency bucket k counts calls taking [2^k, 2^(k+1)) nanoseconds.
+    static const auto latencyBuckets = 32;
+
+    /// Kepler iteration bucket k counts solutions needing k iterations; the last bucket collects the rest.
+    static const auto iterationBuckets = 64;
+
+    /// True when the library was built with the probes compiled in.
+    auto enabled() -> bool;
+
+    /// Snake case name of a probe as used in exported metrics.
+    auto probeName(Probe) -> const char *;
+
+    struct ProbeCounters {
+        std::uint64_t calls = 0;
+        std::uint64_t nanoseconds = 0;
+        std::uint64_t nonFinite = 0;
+        std::array<std::uint64_t, latencyBuckets> latency{};
+    };
+
+    /// Totals over all threads at one moment.
+    struct Snapshot {
+        bool enabled = false;
+        std::array<ProbeCounters, probeCount> probes{};
+        std::array<std::uint64_t, iterationBuckets> keplerIterations{};
+    };
+
+    auto recordCall(Probe, std::uint64_t nanoseconds) -> void;
+
+    auto recordNonFinite(Probe) -> void;
+
+    auto recordKeplerIterations(int) -> void;
+
+    /// Aggregate the counters of every thread.  Safe to call while other threads record.
+    auto snapshot() -> Snapshot;
+
+    /// Start the counters from zero by recording the current totals as a baseline for snapshot() to subtract; no
+    /// thread's counters are written.  A call in flight on another thread counts either before or after the reset,
+    /// never both.
+    auto reset() -> void;
+
+    auto toJson(const Snapshot &) -> std::string;
+
+    /// Prometheus text exposition format, suitable for a node_exporter textfile collector.
+    auto toPrometheus(const Snapshot &) -> std::string;
+
+    /// Replace path with text atomically (write then rename) so a scraper never reads a partial file.
+    auto writeFile(const std::string &path, const std::string &text) -> bool;
+
+    /// Times its enclosing scope and records one call of probe.
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Probe probe0) : probe{probe0}, start{std::chrono::steady_clock::now()} {}
+
+        ScopedTimer(const ScopedTimer &) = delete;
+
+        auto operator=(const ScopedTimer &) -> ScopedTimer & = delete;
+
+        ~ScopedTimer()
+        {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            recordCall(probe, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+
+    private:
+        Probe probe;
+        std::chrono::steady_clock::time_point start;
+    };
+}
+
+#ifdef ORBIT_INSTRUMENTATION
+#define ORBIT_PROBE(probe) \
+    orbit::instrumentation::ScopedTimer orbitProbeTimer{orbit::instrumentation::Probe::probe}
+#define ORBIT_PROBE_FINITE(probe, value) \
+    do { if (!std::isfinite(value)) orbit::instrumentation::recordNonFinite(orbit::instrumentation::Probe::probe); } \
+    while (false)
+#define ORBIT_PROBE_ITERATIONS(n) orbit::instrumentation::recordKeplerIterations(n)
+#else
+#define ORBIT_PROBE(probe) static_cast<void>(0)
+#define ORBIT_PROBE_FINITE(probe, value) static_cast<void>(0)
+#define ORBIT_PROBE_ITERATIONS(n) static_cast<void>(0)
+#endif
+
+#endif //ORBIT_INSTRUMENTATION_HPP
+#pragma clang diagnostic pop
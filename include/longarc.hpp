@@ -0,0 +1,158 @@
+// -*- mode: c++ -*-
+////
+// Long arc propagation of perturbed orbits by symplectic splitting of the Hamiltonian into the Kepler part and the
+// perturbation (Wisdom and Holman, "Symplectic maps for the n-body problem", AJ 102, 1991): exact two-body drifts
+// in universal variables alternate with velocity kicks from the perturbing acceleration.  Because the error scales
+// with the size of the perturbation, steps of a sizable fraction of an orbit stay accurate, and being symplectic
+// the map has no secular drift in energy over thousands of revolutions.
+//
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
+
+#ifndef ORBIT_LONGARC_HPP
+#define ORBIT_LONGARC_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include "constants.hpp"
+#include "orbit.hpp"
+#include "perturbations.hpp"
+#include "propagator.hpp"
+
+namespace orbit {
+    /**
+     * SABA3 with corrector of Laskar and Robutel ("High order symplectic integrators for perturbed Hamiltonian
+     * systems", CMDA 80, 2001): error of order eps h^6 + eps^2 h^4 for a perturbation eps, where the plain
+     * Wisdom-Holman leapfrog is eps h^2.  Each step costs four Kepler solves, three perturbation kicks and one J2
+     * gradient for the corrector.
+     *
+     * The perturbation is J2 and optionally the Sun and Moon from a LuniSolarForce.  The corrector uses J2 alone;
+     * third body terms are small enough at the step sizes used that leaving them out is not visible.  The step is set
+     * per call from the osculating period and eccentricity, so one propagator serves LEO through GEO and Molniya.
+     * Use double for arcs of many revolutions; float round off then dominates the truncation error.
+     * @tparam ScalarType float or double.
+     */
+    template<typename ScalarType>
+    class SymplecticPropagator {
+    public:
+        using stateType = StateVector<ScalarType>;
+        using vector3 = numutil::Vector3<ScalarType>;
+
+        /**
+         * @param stepsPerRevolution0 Steps per period of a circular orbit, more as eccentricity grows; 32 keeps LEO J2
+         *        arcs to centimeters per day.
+         * @param luniSolar0 Optional third body and radiation pressure model, which must outlive the propagator.
+         */
+        explicit SymplecticPropagator(ScalarType mu0 = orbit::muEarth, ScalarType j20 = orbit::earthJ2,
+                                      ScalarType radius0 = orbit::earthEquatorialRadius*1.0e3,
+                                      int stepsPerRevolution0 = 32,
+                                      const LuniSolarForce<ScalarType> *luniSolar0 = nullptr)
+                : kepler{mu0}, j2Factor{-ScalarType(1.5)*j20*mu0*radius0*radius0},
+                  stepsPerRevolution{stepsPerRevolution0}, luniSolar{luniSolar0} {}
+
+        auto gravitationalConstant() const { return kepler.gravitationalConstant(); }
+
+        /// Everything but the point mass, at t seconds past J2000.
+        auto perturbation(double t, const vector3 &r) const -> vector3;
+
+        /// State at time dt (seconds) after the given state, for perturbations that do not depend on time.
+        auto propagate(const stateType &state, ScalarType dt) const -> stateType { return propagate(state, 0.0, dt); }
+
+        /// State at t0 + dt from the state at t0, seconds past J2000.
+        auto propagate(const stateType &, double t0, double dt) const -> stateType;
+
+    private:
+        /// J2 acceleration a and its gradient G; the corrector kick is along G a, the gradient of |a|^2/2.
+        auto correction(const vector3 &r) const -> vector3;
+
+        KeplerPropagator<ScalarType> kepler;
+        ScalarType j2Factor;    // -3/2 J2 mu R^2
+        int stepsPerRevolution;
+        const LuniSolarForce<ScalarType> *luniSolar;
+    };
+
+
+    template<typename ScalarType>
+    auto SymplecticPropagator<ScalarType>::perturbation(double t, const vector3 &r) const -> vector3
+    {
+        auto r2 = r.dot(r);
+        auto r5Inverse = 1/(r2*r2*std::sqrt(r2));
+        auto zRatio = 5*r[2]*r[2]/r2;
+        vector3 result{j2Factor*r5Inverse*r[0]*(1 - zRatio), j2Factor*r5Inverse*r[1]*(1 - zRatio),
+                       j2Factor*r5Inverse*r[2]*(3 - zRatio)};
+        if (luniSolar != nullptr) result += luniSolar->acceleration(t, r);
+        return result;
+    }
+
+
+    template<typename ScalarType>
+    auto SymplecticPropagator<ScalarType>::correction(const vector3 &r) const -> vector3
+    {
+        auto r2 = r.dot(r);
+        auto r5Inverse = 1/(r2*r2*std::sqrt(r2));
+        auto r7Inverse = r5Inverse/r2;
+        auto r9Inverse = r7Inverse/r2;
+        auto z = r[2];
+
+        // As in J2Propagator: a_i = k x_i P_i, da_i/dx_j = k (delta_ij P_i + x_i dP_i/dx_j).
+        ScalarType p[3] = {r5Inverse - 5*z*z*r7Inverse, r5Inverse - 5*z*z*r7Inverse, 3*r5Inverse - 5*z*z*r7Inverse};
+        ScalarType scale[3] = {1, 1, 3};
+        vector3 a{j2Factor*r[0]*p[0], j2Factor*r[1]*p[1], j2Factor*r[2]*p[2]};
+        vector3 result;
+        for (auto i = 0; i < 3; ++i) {
+            for (auto j = 0; j < 3; ++j) {
+                auto pPartial = -5*scale[i]*r[j]*r7Inverse + 35*z*z*r[j]*r9Inverse - (j == 2 ? 10*z*r7Inverse : 0);
+                result[i] += j2Factor*r[i]*pPartial*a[j];
+            }
+            result[i] += j2Factor*p[i]*a[i];
+        }
+        return result;
+    }
+
+
+    template<typename ScalarType>
+    auto SymplecticPropagator<ScalarType>::propagate(const stateType &state, double t0, double dt) const -> stateType
+    {
+        // Drift fractions c1 c2 c2 c1 interleaved with kick fractions d1 d2 d1, and the corrector weight g.
+        static const auto root15 = std::sqrt(15.0);
+        static const auto c1 = 0.5 - root15/10.0;
+        static const auto c2 = root15/10.0;
+        static const auto d1 = 5.0/18.0;
+        static const auto d2 = 4.0/9.0;
+        static const auto g = (54.0 - 13.0*root15)/648.0;
+
+        // Fixed steps must resolve periapsis passage, which takes a fraction (1 - e)^(3/2) of the period.
+        double mu = kepler.gravitationalConstant();
+        double r = state.r.norm();
+        double energy = state.v.dot(state.v)/2.0 - mu/r;
+        double e = (state.v.cross(state.angularMomentum())*ScalarType(1/mu) - state.r.unit()).norm();
+        auto length = energy < 0 ? -mu/(2.0*energy) : r;
+        auto period = 2.0*std::numbers::pi*std::sqrt(length*length*length/mu);
+        auto periapsisScale = period*std::pow(1.0 - std::min(e, 0.99), 1.5);
+        auto steps = std::max(1, static_cast<int>(std::ceil(std::abs(dt)*stepsPerRevolution/periapsisScale)));
+        auto h = dt/steps;
+
+        auto result = state;
+        auto kick = [&](double t, double fraction) { result.v += perturbation(t, result.r)*ScalarType(fraction*h); };
+        auto correct = [&](double weight) { result.v += correction(result.r)*ScalarType(weight*g*h*h*h); };
+        correct(1.0);
+        for (auto step = 0; step < steps; ++step) {
+            auto t = t0 + step*h;
+            result = kepler.propagate(result, ScalarType(c1*h));
+            kick(t + c1*h, d1);
+            result = kepler.propagate(result, ScalarType(c2*h));
+            kick(t + h/2, d2);
+            result = kepler.propagate(result, ScalarType(c2*h));
+            kick(t + (1.0 - c1)*h, d1);
+            result = kepler.propagate(result, ScalarType(c1*h));
+            // The closing corrector of this step and the opening one of the next act at the same point.
+            correct(step + 1 < steps ? 2.0 : 1.0);
+        }
+        return result;
+    }
+}
+
+#endif //ORBIT_LONGARC_HPP
+#pragma clang diagnostic pop
@@ -15,12 +15,27 @@
 
 #include <cmath>
 #include <complex>
+#include <limits>
 #include <numbers>
+#include <type_traits>
 #include "constants.hpp"
+#include "instrumentation.hpp"
 #include "matrix3x3.hpp"
 #include "vector3.hpp"
 
 namespace orbit {
+    /// Gravitational parameter known only at run time, with the reciprocals the kernels multiply by formed once.
+    template<typename ScalarType>
+    struct RuntimeGravity {
+        explicit RuntimeGravity(ScalarType mu0 = orbit::muEarth)
+                : mu{mu0}, muInverse{1/mu0}, sqrtMu{std::sqrt(mu0)}, sqrtMuInverse{1/std::sqrt(mu0)} {}
+
+        ScalarType mu;
+        ScalarType muInverse;
+        ScalarType sqrtMu;
+        ScalarType sqrtMuInverse;
+    };
+
     template<typename ScalarType>
     class KeplerianElements;
 
@@ -32,6 +47,9 @@ namespace orbit {
         vector3 r;
         vector3 v;
 
+        /// Both vectors zero, for preallocating batches of results.
+        StateVector() = default;
+
         StateVector(const vector3 &r0, const vector3 &v0) : r{r0}, v{v0} {}
 
         StateVector(const std::initializer_list<ScalarType> &r0, const std::initializer_list<ScalarType> &v0)
@@ -78,14 +96,20 @@ namespace orbit {
     };
 
 
-    template<typename ScalarType>
-    StateVector<ScalarType>::StateVector(const KeplerianElements<ScalarType> &kepler) {
-        auto specificMomentum = std::sqrt(kepler.gravitationalConstant() * kepler.semiMajorAxis *
-                                          (1.0F - kepler.eccentricity * kepler.eccentricity));
+    /**
+     * Conversion kernels shared by KeplerianElements and the compile time body descriptors of bodies.hpp.
+     * Elements is anything with the six classical element members; Gravity supplies mu, muInverse, sqrtMu and
+     * sqrtMuInverse, as data members of RuntimeGravity or static constants of BodyGravity.
+     */
+    template<typename Elements, typename Gravity>
+    auto stateFromElements(const Elements &kepler, const Gravity &gravity)
+    {
+        using ScalarType = std::remove_cvref_t<decltype(kepler.semiMajorAxis)>;
+        ORBIT_PROBE(stateFromElements);
+        auto semiLatusRectum = kepler.semiMajorAxis*(1 - kepler.eccentricity*kepler.eccentricity);
         std::complex<ScalarType> complexTrueAnomaly{0.0F, kepler.trueAnomaly};
         auto csTrueAnomaly = std::exp(complexTrueAnomaly);
-        auto perifocalRadius = ((specificMomentum * specificMomentum) / kepler.gravitationalConstant()) /
-                               (1.0F + kepler.eccentricity * csTrueAnomaly.real());
+        auto perifocalRadius = semiLatusRectum/(1 + kepler.eccentricity*csTrueAnomaly.real());
         numutil::Vector3<ScalarType> perifocalPosition {
                 perifocalRadius * csTrueAnomaly.real(),
                 perifocalRadius * csTrueAnomaly.imag(),
@@ -94,41 +118,76 @@ namespace orbit {
                 -csTrueAnomaly.imag(),
                 kepler.eccentricity + csTrueAnomaly.real(),
                 0.0F};
-        perifocalVelocity *= kepler.gravitationalConstant()/specificMomentum;
+        // mu/h = sqrt(mu/p)
+        perifocalVelocity *= ScalarType(gravity.sqrtMu)/std::sqrt(semiLatusRectum);
 
         numutil::Matrix3x3<ScalarType> toInertial{kepler.argumentOfPeriapsis,
                                                   kepler.inclination,
                                                   kepler.rightAscensionAscendingNode};
 
-        r = toInertial.transform(perifocalPosition);
-        v = toInertial.transform(perifocalVelocity);
+        StateVector<ScalarType> state{toInertial.transform(perifocalPosition), toInertial.transform(perifocalVelocity)};
+        ORBIT_PROBE_FINITE(stateFromElements, state.r.dot(state.r) + state.v.dot(state.v));
+        return state;
     }
 
-    template<typename ScalarType>
-    KeplerianElements<ScalarType>::KeplerianElements(const StateVector<ScalarType> &state, ScalarType mu0) : mu{mu0}
+    template<typename ScalarType, typename Elements, typename Gravity>
+    auto elementsFromState(const StateVector<ScalarType> &state, const Gravity &gravity, Elements &out) -> void
     {
+        ORBIT_PROBE(elementsFromState);
+        const auto twoPi = ScalarType(2.0*std::numbers::pi);
+        const auto tiny = 64*std::numeric_limits<ScalarType>::epsilon();
+        const auto muInverse = ScalarType(gravity.muInverse);
+
         auto angularMomentum = state.angularMomentum();
         auto hUnit = angularMomentum.unit();
         auto h = angularMomentum.norm();
-        auto e = state.v.cross(angularMomentum) - state.r.unit();
-        numutil::Vector3<ScalarType> nodeVector{-hUnit[1], hUnit[0], 0.0f};
+        auto rUnit = state.r.unit();
+        auto e = state.v.cross(angularMomentum)*muInverse - rUnit;
+        out.eccentricity = e.norm();
+        out.semiMajorAxis = h*h*muInverse/(1 - out.eccentricity*out.eccentricity);
+        // atan2 rather than acos keeps full precision near equatorial and polar orbits.
+        out.inclination = std::atan2(std::hypot(angularMomentum[0], angularMomentum[1]), angularMomentum[2]);
+
+        // Equatorial orbits have no node; measure from the x axis.  Circular orbits have no periapsis; measure the
+        // anomaly from the node.
+        numutil::Vector3<ScalarType> nodeVector{-hUnit[1], hUnit[0], 0};
         auto n = nodeVector.norm();
-        eccentricity = e.norm();
-        semiMajorAxis = h*h/(mu0*(1 - eccentricity*eccentricity));
-        inclination = std::acos(angularMomentum[3]/h);
-        rightAscensionAscendingNode = std::acos(nodeVector[0]/n);
-        if (nodeVector[1] < 0) {
-            rightAscensionAscendingNode = 2.0f*std::numbers::pi - rightAscensionAscendingNode;
-        }
-        argumentOfPeriapsis = std::acos(e.dot(nodeVector)/(eccentricity*n));
-        if (e[2] < 0.0f) {
-            argumentOfPeriapsis = 2.0f*std::numbers::pi - argumentOfPeriapsis;
+        if (n > tiny) {
+            nodeVector *= 1/n;
+            out.rightAscensionAscendingNode = std::atan2(nodeVector[1], nodeVector[0]);
+            if (out.rightAscensionAscendingNode < 0) out.rightAscensionAscendingNode += twoPi;
+        } else {
+            nodeVector = {1, 0, 0};
+            out.rightAscensionAscendingNode = 0;
         }
-        auto rUnit = state.r.unit();
-        trueAnomaly = std::acos(e.dot(rUnit)/(eccentricity));
-        if (state.v.dot(rUnit) < 0.0f) {
-            trueAnomaly = 2.0f*std::numbers::pi - trueAnomaly;
+
+        // Periapsis and anomaly directions in the orbit plane, the second axis being h cross the first.
+        auto angleInPlane = [&](const numutil::Vector3<ScalarType> &from, const numutil::Vector3<ScalarType> &to) {
+            auto result = std::atan2(hUnit.cross(from).dot(to), from.dot(to));
+            return result < 0 ? result + twoPi : result;
+        };
+        if (out.eccentricity > tiny) {
+            auto eUnit = e*(1/out.eccentricity);
+            out.argumentOfPeriapsis = angleInPlane(nodeVector, eUnit);
+            out.trueAnomaly = angleInPlane(eUnit, rUnit);
+        } else {
+            out.argumentOfPeriapsis = 0;
+            out.trueAnomaly = angleInPlane(nodeVector, rUnit);
         }
+        ORBIT_PROBE_FINITE(elementsFromState, out.semiMajorAxis + out.eccentricity + out.inclination
+                                              + out.rightAscensionAscendingNode + out.argumentOfPeriapsis
+                                              + out.trueAnomaly);
+    }
+
+
+    template<typename ScalarType>
+    StateVector<ScalarType>::StateVector(const KeplerianElements<ScalarType> &kepler)
+            : StateVector{stateFromElements(kepler, RuntimeGravity<ScalarType>{kepler.gravitationalConstant()})} {}
+
+    template<typename ScalarType>
+    KeplerianElements<ScalarType>::KeplerianElements(const StateVector<ScalarType> &state, ScalarType mu0) : mu{mu0}
+    {
+        elementsFromState(state, RuntimeGravity<ScalarType>{mu0}, *this);
     }
 
 }
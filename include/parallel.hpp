@@ -0,0 +1,86 @@
+// -*- mode: c++ -*-
+////
+// Minimal fork-join helper for running independent per-object work on all cores.
+//
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
+
+#ifndef ORBIT_PARALLEL_HPP
+#define ORBIT_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace numutil {
+    /// Number of workers used when a caller asks for 0.
+    inline auto defaultConcurrency() -> unsigned
+    {
+        auto n = std::thread::hardware_concurrency();
+        return n > 0 ? n : 1;
+    }
+
+    /// Number of workers parallelFor will actually start for count items in chunks of grain, never more than chunks.
+    inline auto workerCount(std::size_t count, unsigned workers = 0, std::size_t grain = 0) -> unsigned
+    {
+        if (workers == 0) workers = defaultConcurrency();
+        auto chunks = grain == 0 ? count : (count + grain - 1)/grain;
+        return static_cast<unsigned>(std::max<std::size_t>(1, std::min<std::size_t>(workers, chunks)));
+    }
+
+    /**
+     * Call body(begin, end, worker) over chunks of [0, count), handing chunks out dynamically so uneven work balances.
+     * Worker indices run 0..workerCount(count, workers, grain)-1 and each worker is a single thread, so callers can
+     * keep one scratch workspace per worker index without locking.  Worker 0 runs on the calling thread.
+     * The first exception thrown by body is rethrown after all workers finish.
+     * Every call starts and joins its own threads, tens of microseconds each, so callers with cheap items that run
+     * often should pass a grain worth that much work: no more workers start than there are chunks, and a count of at
+     * most one grain runs entirely on the calling thread.
+     * @param count Number of items.
+     * @param body Callable taking (std::size_t begin, std::size_t end, unsigned worker).
+     * @param workers Number of threads, 0 for one per hardware thread.
+     * @param grain Items per chunk, 0 to pick one giving each worker several chunks.
+     */
+    template<typename Body>
+    auto parallelFor(std::size_t count, Body &&body, unsigned workers = 0, std::size_t grain = 0) -> void
+    {
+        if (count == 0) return;
+        auto n = workerCount(count, workers, grain);
+        if (grain == 0) grain = std::max<std::size_t>(1, count/(8*n));
+        if (n == 1) {
+            body(std::size_t{0}, count, 0u);
+            return;
+        }
+
+        std::atomic<std::size_t> next{0};
+        std::exception_ptr failure;
+        std::mutex failureMutex;
+        auto work = [&](unsigned worker) {
+            try {
+                for (auto begin = next.fetch_add(grain); begin < count; begin = next.fetch_add(grain)) {
+                    body(begin, std::min(begin + grain, count), worker);
+                }
+            } catch (...) {
+                std::lock_guard lock{failureMutex};
+                if (!failure) failure = std::current_exception();
+                next = count;
+            }
+        };
+
+        {
+            std::vector<std::jthread> threads;
+            threads.reserve(n - 1);
+            for (auto worker = 1u; worker < n; ++worker) threads.emplace_back(work, worker);
+            work(0);
+        }
+        if (failure) std::rethrow_exception(failure);
+    }
+}
+
+#endif //ORBIT_PARALLEL_HPP
+#pragma clang diagnostic pop
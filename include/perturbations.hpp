@@ -0,0 +1,141 @@
+// -*- mode: c++ -*-
+////
+// Third body (Sun and Moon) and cannonball solar radiation pressure accelerations with the conical Earth shadow
+// function (Montenbruck and Gill, Satellite Orbits, sections 3.2 and 3.4).  Positions in meters, geocentric inertial.
+//
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
+
+#ifndef ORBIT_PERTURBATIONS_HPP
+#define ORBIT_PERTURBATIONS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+#include "constants.hpp"
+#include "ephemeris.hpp"
+#include "vector3.hpp"
+
+namespace orbit {
+    /**
+     * Perturbing acceleration of a third body on a satellite, relative to the central body.
+     * Uses Battin's f(q) form, which avoids the cancellation between the direct and indirect terms when the body is
+     * far away, so the Sun term is accurate even in float.
+     * @param r Satellite position.
+     * @param body Third body position.
+     * @param mu Gravitational parameter of the third body.
+     */
+    template<typename ScalarType>
+    auto thirdBodyAcceleration(const numutil::Vector3<ScalarType> &r, const numutil::Vector3<ScalarType> &body,
+                               ScalarType mu) -> numutil::Vector3<ScalarType>
+    {
+        auto d = body - r;
+        auto distance = d.norm();
+        auto q = r.dot(r - ScalarType(2)*body)/body.dot(body);
+        auto f = q*(3 + 3*q + q*q)/(1 + std::pow(1 + q, ScalarType(1.5)));
+        return (r + body*f)*(-mu/(distance*distance*distance));
+    }
+
+
+    /**
+     * Apparent radius of the Sun, apparent radius of the Earth and apparent separation of their centers seen from r,
+     * radians.  The satellite is in penumbra where the separation is below the sum of the radii and in umbra where it
+     * is below their difference.
+     * @param r Satellite position.
+     * @param sun Sun position.
+     */
+    template<typename ScalarType>
+    auto shadowAngles(const numutil::Vector3<ScalarType> &r, const numutil::Vector3<ScalarType> &sun)
+            -> std::array<ScalarType, 3>
+    {
+        auto toSun = sun - r;
+        auto rNorm = r.norm();
+        auto dNorm = toSun.norm();
+        return {std::asin(std::min(ScalarType(sunRadius/dNorm), ScalarType(1))),
+                std::asin(std::min(ScalarType(earthEquatorialRadius*1.0e3/rNorm), ScalarType(1))),
+                std::acos(std::clamp(-r.dot(toSun)/(rNorm*dNorm), ScalarType(-1), ScalarType(1)))};
+    }
+
+
+    /**
+     * Fraction of the solar disk visible from r past the Earth, treating both as spheres: 1 in sunlight, 0 in umbra,
+     * between in penumbra or annular eclipse.
+     * @param r Satellite position.
+     * @param sun Sun position.
+     */
+    template<typename ScalarType>
+    auto shadowFunction(const numutil::Vector3<ScalarType> &r, const numutil::Vector3<ScalarType> &sun) -> ScalarType
+    {
+        auto [a, b, c] = shadowAngles(r, sun);
+        if (c >= a + b) return 1;
+        if (c <= b - a) return 0;
+        if (c <= a - b) return 1 - (b*b)/(a*a);
+
+        auto x = (c*c + a*a - b*b)/(2*c);
+        auto y = std::sqrt(std::max(a*a - x*x, ScalarType(0)));
+        auto area = a*a*std::acos(std::clamp(x/a, ScalarType(-1), ScalarType(1)))
+                    + b*b*std::acos(std::clamp((c - x)/b, ScalarType(-1), ScalarType(1))) - c*y;
+        return std::clamp(1 - area/(ScalarType(std::numbers::pi)*a*a), ScalarType(0), ScalarType(1));
+    }
+
+
+    /**
+     * Cannonball solar radiation pressure, scaled by the shadow function and the inverse square of the distance to
+     * the Sun.
+     * @param r Satellite position.
+     * @param sun Sun position.
+     * @param areaToMass Cross section over mass, m^2/kg.
+     * @param reflectivity Radiation pressure coefficient, 1 absorbing to 2 mirror.
+     */
+    template<typename ScalarType>
+    auto solarRadiationPressure(const numutil::Vector3<ScalarType> &r, const numutil::Vector3<ScalarType> &sun,
+                                ScalarType areaToMass, ScalarType reflectivity) -> numutil::Vector3<ScalarType>
+    {
+        auto nu = shadowFunction(r, sun);
+        if (nu == 0) return {};
+        auto fromSun = r - sun;
+        auto distance = fromSun.norm();
+        auto scale = ScalarType(astronomicalUnit)/distance;
+        return fromSun*(nu*ScalarType(solarPressure)*scale*scale*reflectivity*areaToMass/distance);
+    }
+
+
+    /**
+     * Sun and Moon third body and solar radiation pressure accelerations for one satellite, reading body positions
+     * from a shared EphemerisCache.  Holds a pointer to the cache, which must outlive it; cheap to copy per object.
+     */
+    template<typename ScalarType>
+    class LuniSolarForce {
+    public:
+        using vector3 = numutil::Vector3<ScalarType>;
+
+        /// areaToMass of zero turns radiation pressure off.
+        explicit LuniSolarForce(const EphemerisCache<ScalarType> &ephemeris0, ScalarType areaToMass0 = 0,
+                                ScalarType reflectivity0 = ScalarType(1.3))
+                : ephemeris{&ephemeris0}, areaToMass{areaToMass0}, reflectivity{reflectivity0} {}
+
+        /// Total perturbing acceleration at t seconds past J2000.
+        auto acceleration(double t, const vector3 &r) const -> vector3;
+
+    private:
+        const EphemerisCache<ScalarType> *ephemeris;
+        ScalarType areaToMass;
+        ScalarType reflectivity;
+    };
+
+
+    template<typename ScalarType>
+    auto LuniSolarForce<ScalarType>::acceleration(double t, const vector3 &r) const -> vector3
+    {
+        auto sun = ephemeris->sun(t);
+        auto result = thirdBodyAcceleration(r, sun, ScalarType(muSun))
+                      + thirdBodyAcceleration(r, ephemeris->moon(t), ScalarType(muMoon));
+        if (areaToMass > 0) result += solarRadiationPressure(r, sun, areaToMass, reflectivity);
+        return result;
+    }
+}
+
+#endif //ORBIT_PERTURBATIONS_HPP
+#pragma clang diagnostic pop
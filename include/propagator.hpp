@@ -0,0 +1,583 @@
+// -*- mode: c++ -*-
+////
+// Two-body propagation of a StateVector in universal variables, with the analytic state transition matrix used by
+// orbit determination.  Works for elliptic, parabolic and hyperbolic orbits alike.  J2Propagator adds Earth
+// oblateness by numerical integration behind the same interface, and SecularJ2Propagator its secular drift in
+// closed form.
+//
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedStructInspection"
+#pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
+
+#ifndef ORBIT_PROPAGATOR_HPP
+#define ORBIT_PROPAGATOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <type_traits>
+#include "constants.hpp"
+#include "instrumentation.hpp"
+#include "matrix3x3.hpp"
+#include "orbit.hpp"
+#include "vector3.hpp"
+
+namespace orbit {
+    /// 6x6 matrix laid out [row][column] over the state (x, y, z, vx, vy, vz).
+    template<typename ScalarType>
+    using Matrix6x6 = std::array<std::array<ScalarType, 6>, 6>;
+
+    /**
+     * Universal functions U0..U5 of the universal anomaly chi for the reciprocal semi-major axis alpha.
+     * U_n = chi^n c_n(alpha*chi^2) where c_n are the Stumpff functions.
+     */
+    template<typename ScalarType>
+    class UniversalFunctions {
+    public:
+        static const auto count = 6;
+
+        UniversalFunctions(ScalarType chi, ScalarType alpha);
+
+        auto operator[](int n) const -> ScalarType { return u[n]; }
+
+        /// Partial of U_n with respect to alpha holding chi fixed, n <= 3.
+        auto alphaPartial(int n) const -> ScalarType { return (ScalarType(n)*u[n + 2] - chi*u[n + 1])/2; }
+
+    private:
+        ScalarType chi;
+        ScalarType u[count];
+    };
+
+
+    /**
+     * Solve Kepler's equation in universal variables and propagate a state vector over a time interval.
+     * @tparam ScalarType float or double.
+     * @tparam Gravity RuntimeGravity for a gravitational parameter given at construction, or BodyGravity from
+     *         bodies.hpp to fix it at compile time.
+     */
+    template<typename ScalarType, typename Gravity = RuntimeGravity<ScalarType>>
+    class KeplerPropagator {
+    public:
+        using stateType = StateVector<ScalarType>;
+
+        /// Maximum number of Laguerre iterations on the universal anomaly.
+        static const auto maxIterations = 50;
+
+        explicit KeplerPropagator(ScalarType mu0 = orbit::muEarth)
+            requires std::is_same_v<Gravity, RuntimeGravity<ScalarType>> : gravity{mu0} {}
+
+        KeplerPropagator() requires (!std::is_same_v<Gravity, RuntimeGravity<ScalarType>>) = default;
+
+        auto gravitationalConstant() const -> ScalarType { return gravity.mu; }
+
+        /// State at time dt (seconds) after the given state.
+        auto propagate(const stateType &, ScalarType dt) const -> stateType;
+
+        /// State at dt after the given state, also returning d(state(dt))/d(state(0)) in stm.
+        auto propagate(const stateType &, ScalarType dt, Matrix6x6<ScalarType> &stm) const -> stateType;
+
+        /// Number of iterations the most recent call on this thread needed to solve Kepler's equation.
+        static auto lastIterations() -> int { return iterations; }
+
+    private:
+        /// Everything about one solution of Kepler's equation the Lagrange coefficients and their partials need.
+        struct Solution {
+            ScalarType r0;      // |r0|
+            ScalarType sigma0;  // r0.v0/sqrt(mu)
+            ScalarType alpha;   // 1/a
+            ScalarType chi;     // universal anomaly
+            ScalarType r;       // |r(dt)|
+        };
+
+        auto solve(const stateType &, ScalarType dt) const -> Solution;
+
+        [[no_unique_address]] Gravity gravity;
+        static thread_local inline int iterations = 0;
+    };
+
+
+    template<typename ScalarType>
+    UniversalFunctions<ScalarType>::UniversalFunctions(ScalarType chi0, ScalarType alpha) : chi{chi0}
+    {
+        auto z = alpha*chi*chi;
+        ScalarType c2, c3, c4, c5;
+        if (std::abs(z) < ScalarType(0.1)) {
+            // c_n(z) = sum (-z)^k/(2k + n)!
+            auto series = [z](int n, ScalarType term) {
+                ScalarType sum = 0;
+                for (auto k = 0; k < 10; ++k) {
+                    sum += term;
+                    term *= -z/ScalarType((2*k + n + 1)*(2*k + n + 2));
+                }
+                return sum;
+            };
+            c4 = series(4, ScalarType(1.0/24.0));
+            c5 = series(5, ScalarType(1.0/120.0));
+            c2 = ScalarType(0.5) - z*c4;
+            c3 = ScalarType(1.0/6.0) - z*c5;
+        } else {
+            if (z > 0) {
+                auto s = std::sqrt(z);
+                c2 = (1 - std::cos(s))/z;
+                c3 = (s - std::sin(s))/(s*z);
+            } else {
+                auto s = std::sqrt(-z);
+                c2 = (std::cosh(s) - 1)/(-z);
+                c3 = (std::sinh(s) - s)/(s*(-z));
+            }
+            c4 = (ScalarType(0.5) - c2)/z;
+            c5 = (ScalarType(1.0/6.0) - c3)/z;
+        }
+        auto c0 = 1 - z*c2;
+        auto c1 = 1 - z*c3;
+
+        auto chi2 = chi*chi;
+        u[0] = c0;
+        u[1] = chi*c1;
+        u[2] = chi2*c2;
+        u[3] = chi2*chi*c3;
+        u[4] = chi2*chi2*c4;
+        u[5] = chi2*chi2*chi*c5;
+    }
+
+
+    template<typename ScalarType, typename Gravity>
+    auto KeplerPropagator<ScalarType, Gravity>::solve(const stateType &state, ScalarType dt) const -> Solution
+    {
+        Solution s{};
+        s.r0 = state.r.norm();
+        s.sigma0 = state.r.dot(state.v)*gravity.sqrtMuInverse;
+        s.alpha = 2/s.r0 - state.v.dot(state.v)*gravity.muInverse;
+
+        // Initial guesses after Vallado, Fundamentals of Astrodynamics, algorithm 8.
+        auto target = gravity.sqrtMu*dt;
+        if (s.alpha > std::numeric_limits<ScalarType>::epsilon()/s.r0) {
+            s.chi = target*s.alpha;
+        } else if (s.alpha < -std::numeric_limits<ScalarType>::epsilon()/s.r0) {
+            auto a = 1/s.alpha;
+            auto sign = dt < 0 ? ScalarType(-1) : ScalarType(1);
+            auto denominator = state.r.dot(state.v) + sign*std::sqrt(-gravity.mu*a)*(1 - s.r0*s.alpha);
+            auto ratio = -2*gravity.mu*s.alpha*dt/denominator;
+            s.chi = ratio > 0 ? sign*std::sqrt(-a)*std::log(ratio) : target/s.r0;
+        } else {
+            s.chi = target/s.r0;
+        }
+
+        // Laguerre-Conway iteration, which converges from nearly any starting point.
+        const ScalarType n = 5;
+        auto tolerance = 4*std::numeric_limits<ScalarType>::epsilon();
+        iterations = 0;
+        while (iterations < maxIterations) {
+            ++iterations;
+            UniversalFunctions<ScalarType> u{s.chi, s.alpha};
+            auto f = s.r0*u[1] + s.sigma0*u[2] + u[3] - target;
+            auto fPrime = s.r0*u[0] + s.sigma0*u[1] + u[2];
+            auto fSecond = s.sigma0*u[0] + (1 - s.alpha*s.r0)*u[1];
+            auto root = std::sqrt(std::abs((n - 1)*(n - 1)*fPrime*fPrime - n*(n - 1)*f*fSecond));
+            auto delta = n*f/(fPrime + (fPrime < 0 ? -root : root));
+            s.chi -= delta;
+            if (std::abs(delta) <= tolerance*std::max(ScalarType(1), std::abs(s.chi))) break;
+        }
+        ORBIT_PROBE_ITERATIONS(iterations);
+
+        UniversalFunctions<ScalarType> u{s.chi, s.alpha};
+        s.r = s.r0*u[0] + s.sigma0*u[1] + u[2];
+        return s;
+    }
+
+
+    template<typename ScalarType, typename Gravity>
+    auto KeplerPropagator<ScalarType, Gravity>::propagate(const stateType &state, ScalarType dt) const -> stateType
+    {
+        ORBIT_PROBE(keplerPropagate);
+        auto s = solve(state, dt);
+        UniversalFunctions<ScalarType> u{s.chi, s.alpha};
+
+        auto f = 1 - u[2]/s.r0;
+        auto g = (s.r0*u[1] + s.sigma0*u[2])*gravity.sqrtMuInverse;
+        auto fDot = -gravity.sqrtMu*u[1]/(s.r*s.r0);
+        auto gDot = 1 - u[2]/s.r;
+
+        stateType result{f*state.r + g*state.v, fDot*state.r + gDot*state.v};
+        ORBIT_PROBE_FINITE(keplerPropagate, result.r.dot(result.r) + result.v.dot(result.v));
+        return result;
+    }
+
+
+    template<typename ScalarType, typename Gravity>
+    auto KeplerPropagator<ScalarType, Gravity>::propagate(const stateType &state, ScalarType dt,
+                                                 Matrix6x6<ScalarType> &stm) const -> stateType
+    {
+        ORBIT_PROBE(keplerPartials);
+        auto s = solve(state, dt);
+        UniversalFunctions<ScalarType> u{s.chi, s.alpha};
+
+        auto f = 1 - u[2]/s.r0;
+        auto g = (s.r0*u[1] + s.sigma0*u[2])*gravity.sqrtMuInverse;
+        auto fDot = -gravity.sqrtMu*u[1]/(s.r*s.r0);
+        auto gDot = 1 - u[2]/s.r;
+
+        // The Lagrange coefficients depend on the initial state only through r0, sigma0 and alpha, both directly
+        // and through chi, which Kepler's equation K(chi; r0, sigma0, alpha) = 0 fixes implicitly.  Index the three
+        // parameters 0: r0, 1: sigma0, 2: alpha.
+        ScalarType u0Partial[3] = {0, 0, u.alphaPartial(0)};
+        ScalarType u1Partial[3] = {0, 0, u.alphaPartial(1)};
+        ScalarType u2Partial[3] = {0, 0, u.alphaPartial(2)};
+        ScalarType keplerPartial[3] = {u[1], u[2], s.r0*u1Partial[2] + s.sigma0*u2Partial[2] + u.alphaPartial(3)};
+
+        // Total derivatives of U0, U1, U2 including the implicit dependence through chi.
+        ScalarType r0Partial[3] = {1, 0, 0};
+        ScalarType sigmaPartial[3] = {0, 1, 0};
+        ScalarType rPartial[3];
+        for (auto k = 0; k < 3; ++k) {
+            auto chiPartial = -keplerPartial[k]/s.r;
+            u0Partial[k] += -s.alpha*u[1]*chiPartial;
+            u1Partial[k] += u[0]*chiPartial;
+            u2Partial[k] += u[1]*chiPartial;
+            rPartial[k] = r0Partial[k]*u[0] + s.r0*u0Partial[k] + sigmaPartial[k]*u[1] + s.sigma0*u1Partial[k]
+                          + u2Partial[k];
+        }
+
+        ScalarType fPartial[3], gPartial[3], fDotPartial[3], gDotPartial[3];
+        for (auto k = 0; k < 3; ++k) {
+            fPartial[k] = -u2Partial[k]/s.r0 + r0Partial[k]*u[2]/(s.r0*s.r0);
+            gPartial[k] = (r0Partial[k]*u[1] + s.r0*u1Partial[k] + sigmaPartial[k]*u[2] + s.sigma0*u2Partial[k])
+                          *gravity.sqrtMuInverse;
+            fDotPartial[k] = -gravity.sqrtMu*u1Partial[k]/(s.r*s.r0) - fDot*(rPartial[k]/s.r + r0Partial[k]/s.r0);
+            gDotPartial[k] = -u2Partial[k]/s.r + u[2]*rPartial[k]/(s.r*s.r);
+        }
+
+        // Gradients of r0, sigma0 and alpha with respect to the initial position (0..2) and velocity (3..5).
+        ScalarType parameterGradient[3][6];
+        for (auto j = 0; j < 3; ++j) {
+            parameterGradient[0][j] = state.r[j]/s.r0;
+            parameterGradient[0][j + 3] = 0;
+            parameterGradient[1][j] = state.v[j]*gravity.sqrtMuInverse;
+            parameterGradient[1][j + 3] = state.r[j]*gravity.sqrtMuInverse;
+            parameterGradient[2][j] = -2*state.r[j]/(s.r0*s.r0*s.r0);
+            parameterGradient[2][j + 3] = -2*state.v[j]*gravity.muInverse;
+        }
+
+        auto gradient = [&parameterGradient](const ScalarType (&partial)[3], int j) {
+            return partial[0]*parameterGradient[0][j] + partial[1]*parameterGradient[1][j]
+                   + partial[2]*parameterGradient[2][j];
+        };
+
+        for (auto j = 0; j < 6; ++j) {
+            auto fGradient = gradient(fPartial, j);
+            auto gGradient = gradient(gPartial, j);
+            auto fDotGradient = gradient(fDotPartial, j);
+            auto gDotGradient = gradient(gDotPartial, j);
+            for (auto i = 0; i < 3; ++i) {
+                stm[i][j] = state.r[i]*fGradient + state.v[i]*gGradient;
+                stm[i + 3][j] = state.r[i]*fDotGradient + state.v[i]*gDotGradient;
+            }
+        }
+        for (auto i = 0; i < 3; ++i) {
+            stm[i][i] += f;
+            stm[i][i + 3] += g;
+            stm[i + 3][i] += fDot;
+            stm[i + 3][i + 3] += gDot;
+        }
+
+        stateType result{f*state.r + g*state.v, fDot*state.r + gDot*state.v};
+        ORBIT_PROBE_FINITE(keplerPartials, result.r.dot(result.r) + result.v.dot(result.v));
+        return result;
+    }
+
+    /**
+     * Point mass plus J2 oblateness propagated by fixed step fourth order Runge-Kutta (Cowell's method), with the
+     * state transition matrix integrated alongside from the variational equations.  Same interface as
+     * KeplerPropagator so either can drive a filter.
+     * @tparam ScalarType float or double.
+     */
+    template<typename ScalarType>
+    class J2Propagator {
+    public:
+        using stateType = StateVector<ScalarType>;
+        using vector3 = numutil::Vector3<ScalarType>;
+
+        explicit J2Propagator(ScalarType mu0 = orbit::muEarth, ScalarType j20 = orbit::earthJ2,
+                              ScalarType radius0 = orbit::earthEquatorialRadius*1.0e3, ScalarType maxStep0 = 30)
+                : mu{mu0}, j2Factor{-ScalarType(1.5)*j20*mu0*radius0*radius0}, maxStep{maxStep0} {}
+
+        auto gravitationalConstant() const { return mu; }
+
+        /// Gravitational acceleration at r.
+        auto acceleration(const vector3 &r) const -> vector3;
+
+        /// Acceleration at r and its gradient d(acceleration)/dr.
+        auto acceleration(const vector3 &r, ScalarType (&gradient)[3][3]) const -> vector3;
+
+        /// State at time dt (seconds) after the given state.
+        auto propagate(const stateType &, ScalarType dt) const -> stateType;
+
+        /// State at dt after the given state, also returning d(state(dt))/d(state(0)) in stm.
+        auto propagate(const stateType &, ScalarType dt, Matrix6x6<ScalarType> &stm) const -> stateType;
+
+    private:
+        ScalarType mu;
+        ScalarType j2Factor;    // -3/2 J2 mu R^2
+        ScalarType maxStep;     // seconds
+    };
+
+
+    template<typename ScalarType>
+    auto J2Propagator<ScalarType>::acceleration(const vector3 &r) const -> vector3
+    {
+        auto r2 = r.dot(r);
+        auto rInverse = 1/std::sqrt(r2);
+        auto r3Inverse = rInverse/r2;
+        auto r5Inverse = r3Inverse/r2;
+        auto zRatio = 5*r[2]*r[2]/r2;
+        auto result = r*(-mu*r3Inverse);
+        result[0] += j2Factor*r5Inverse*r[0]*(1 - zRatio);
+        result[1] += j2Factor*r5Inverse*r[1]*(1 - zRatio);
+        result[2] += j2Factor*r5Inverse*r[2]*(3 - zRatio);
+        return result;
+    }
+
+
+    template<typename ScalarType>
+    auto J2Propagator<ScalarType>::acceleration(const vector3 &r, ScalarType (&gradient)[3][3]) const -> vector3
+    {
+        auto r2 = r.dot(r);
+        auto rInverse = 1/std::sqrt(r2);
+        auto r3Inverse = rInverse/r2;
+        auto r5Inverse = r3Inverse/r2;
+        auto r7Inverse = r5Inverse/r2;
+        auto r9Inverse = r7Inverse/r2;
+        auto z = r[2];
+
+        // Point mass: mu/r^3 (3 r r^T/r^2 - I).  J2: a_i = k x_i P_i with P = 1/r^5 - 5 z^2/r^7 for x and y and
+        // 3/r^5 - 5 z^2/r^7 for z, so da_i/dx_j = k (delta_ij P_i + x_i dP_i/dx_j).
+        ScalarType p[3] = {r5Inverse - 5*z*z*r7Inverse, r5Inverse - 5*z*z*r7Inverse, 3*r5Inverse - 5*z*z*r7Inverse};
+        ScalarType scale[3] = {1, 1, 3};
+        for (auto i = 0; i < 3; ++i) {
+            for (auto j = 0; j < 3; ++j) {
+                auto pPartial = -5*scale[i]*r[j]*r7Inverse + 35*z*z*r[j]*r9Inverse - (j == 2 ? 10*z*r7Inverse : 0);
+                gradient[i][j] = 3*mu*r5Inverse*r[i]*r[j] + j2Factor*r[i]*pPartial;
+            }
+            gradient[i][i] += -mu*r3Inverse + j2Factor*p[i];
+        }
+
+        auto result = r*(-mu*r3Inverse);
+        for (auto i = 0; i < 3; ++i) result[i] += j2Factor*r[i]*p[i];
+        return result;
+    }
+
+
+    template<typename ScalarType>
+    auto J2Propagator<ScalarType>::propagate(const stateType &state, ScalarType dt) const -> stateType
+    {
+        ORBIT_PROBE(j2Propagate);
+        auto steps = std::max(1, static_cast<int>(std::ceil(std::abs(dt)/maxStep)));
+        auto h = dt/ScalarType(steps);
+        auto r = state.r;
+        auto v = state.v;
+        for (auto step = 0; step < steps; ++step) {
+            auto k1v = acceleration(r);
+            auto k1r = v;
+            auto k2v = acceleration(r + k1r*(h/2));
+            auto k2r = v + k1v*(h/2);
+            auto k3v = acceleration(r + k2r*(h/2));
+            auto k3r = v + k2v*(h/2);
+            auto k4v = acceleration(r + k3r*h);
+            auto k4r = v + k3v*h;
+            r += (k1r + ScalarType(2)*(k2r + k3r) + k4r)*(h/6);
+            v += (k1v + ScalarType(2)*(k2v + k3v) + k4v)*(h/6);
+        }
+        ORBIT_PROBE_FINITE(j2Propagate, r.dot(r) + v.dot(v));
+        return {r, v};
+    }
+
+
+    template<typename ScalarType>
+    auto J2Propagator<ScalarType>::propagate(const stateType &state, ScalarType dt,
+                                             Matrix6x6<ScalarType> &stm) const -> stateType
+    {
+        ORBIT_PROBE(j2Partials);
+        // y = (r, v, Phi) with r' = v, v' = a(r), Phi' = [[0, I], [da/dr, 0]] Phi.
+        struct Derivative {
+            vector3 r, v;
+            Matrix6x6<ScalarType> phi;
+        };
+        auto derivative = [this](const vector3 &r, const vector3 &v, const Matrix6x6<ScalarType> &phi) {
+            Derivative d;
+            ScalarType gradient[3][3];
+            d.r = v;
+            d.v = acceleration(r, gradient);
+            for (auto j = 0; j < 6; ++j) {
+                for (auto i = 0; i < 3; ++i) {
+                    d.phi[i][j] = phi[i + 3][j];
+                    d.phi[i + 3][j] = gradient[i][0]*phi[0][j] + gradient[i][1]*phi[1][j] + gradient[i][2]*phi[2][j];
+                }
+            }
+            return d;
+        };
+        auto advance = [](const Matrix6x6<ScalarType> &phi, const Derivative &d, ScalarType h) {
+            auto result = phi;
+            for (auto i = 0; i < 6; ++i) {
+                for (auto j = 0; j < 6; ++j) result[i][j] += h*d.phi[i][j];
+            }
+            return result;
+        };
+
+        for (auto i = 0; i < 6; ++i) {
+            stm[i].fill(0);
+            stm[i][i] = 1;
+        }
+        auto steps = std::max(1, static_cast<int>(std::ceil(std::abs(dt)/maxStep)));
+        auto h = dt/ScalarType(steps);
+        auto r = state.r;
+        auto v = state.v;
+        for (auto step = 0; step < steps; ++step) {
+            auto k1 = derivative(r, v, stm);
+            auto k2 = derivative(r + k1.r*(h/2), v + k1.v*(h/2), advance(stm, k1, h/2));
+            auto k3 = derivative(r + k2.r*(h/2), v + k2.v*(h/2), advance(stm, k2, h/2));
+            auto k4 = derivative(r + k3.r*h, v + k3.v*h, advance(stm, k3, h));
+            r += (k1.r + ScalarType(2)*(k2.r + k3.r) + k4.r)*(h/6);
+            v += (k1.v + ScalarType(2)*(k2.v + k3.v) + k4.v)*(h/6);
+            for (auto i = 0; i < 6; ++i) {
+                for (auto j = 0; j < 6; ++j) {
+                    stm[i][j] += (k1.phi[i][j] + 2*k2.phi[i][j] + 2*k3.phi[i][j] + k4.phi[i][j])*(h/6);
+                }
+            }
+        }
+        ORBIT_PROBE_FINITE(j2Partials, r.dot(r) + v.dot(v));
+        return {r, v};
+    }
+
+
+    /**
+     * Analytic mean element motion: a fixed ellipse whose node, argument of periapsis and mean anomaly drift at the
+     * first order secular J2 rates.  Orders of magnitude cheaper than integration and good enough where the short
+     * periodic terms (kilometers) do not matter, such as predicting eclipses over long spans.  Elliptic orbits only.
+     * Times are absolute seconds, kept in double so long spans keep their resolution even for float elements.
+     * @tparam ScalarType float or double.
+     */
+    template<typename ScalarType>
+    class SecularJ2Propagator {
+    public:
+        using stateType = StateVector<ScalarType>;
+        using vector3 = numutil::Vector3<ScalarType>;
+
+        /// elements hold at time epoch0; a j20 of zero gives plain two-body motion.
+        explicit SecularJ2Propagator(const KeplerianElements<ScalarType> &elements, double epoch0 = 0,
+                                     ScalarType j20 = orbit::earthJ2,
+                                     ScalarType radius0 = orbit::earthEquatorialRadius*1.0e3);
+
+        auto semiMajorAxis() const -> ScalarType { return a; }
+
+        auto eccentricity() const -> ScalarType { return e; }
+
+        /// Mean motion including the J2 correction, radians per second.
+        auto meanMotion() const -> double { return n; }
+
+        /// Anomalistic period, seconds.
+        auto period() const -> double { return 2.0*std::numbers::pi/n; }
+
+        /// Mean anomaly at t, not reduced modulo 2 pi so it also counts revolutions.
+        auto meanAnomaly(double t) const -> double { return meanAnomaly0 + n*(t - epoch); }
+
+        /// Time at which the mean anomaly reaches m.
+        auto timeOfMeanAnomaly(double m) const -> double { return epoch + (m - meanAnomaly0)/n; }
+
+        /// Largest rate, radians per second, at which the node and periapsis turn the orbit.
+        auto precessionRate() const -> double { return std::abs(nodeRate) + std::abs(periapsisRate); }
+
+        /// Perifocal to inertial rotation at t.
+        auto orientation(double t) const -> numutil::Matrix3x3<ScalarType>
+        {
+            return {ScalarType(argumentOfPeriapsis0 + periapsisRate*(t - epoch)), inclination,
+                    ScalarType(node0 + nodeRate*(t - epoch))};
+        }
+
+        /// Solve Kepler's equation for the eccentric anomaly.
+        auto eccentricAnomaly(ScalarType meanAnomaly) const -> ScalarType;
+
+        /// Position at t.
+        auto position(double t) const -> vector3;
+
+        /// Position and velocity at t.
+        auto propagate(double t) const -> stateType;
+
+    private:
+        double epoch;
+        ScalarType a;
+        ScalarType e;
+        ScalarType inclination;
+        double node0;
+        double argumentOfPeriapsis0;
+        double meanAnomaly0;
+        double n;
+        double nodeRate;
+        double periapsisRate;
+    };
+
+
+    template<typename ScalarType>
+    SecularJ2Propagator<ScalarType>::SecularJ2Propagator(const KeplerianElements<ScalarType> &elements, double epoch0,
+                                                         ScalarType j20, ScalarType radius0)
+            : epoch{epoch0}, a{elements.semiMajorAxis}, e{elements.eccentricity}, inclination{elements.inclination},
+              node0{elements.rightAscensionAscendingNode}, argumentOfPeriapsis0{elements.argumentOfPeriapsis}
+    {
+        double mu = elements.gravitationalConstant();
+        double ecc = e;
+        double nu = elements.trueAnomaly;
+        auto halfAnomaly = std::atan2(std::sqrt(1.0 - ecc)*std::sin(nu/2.0), std::sqrt(1.0 + ecc)*std::cos(nu/2.0));
+        meanAnomaly0 = 2.0*halfAnomaly - ecc*std::sin(2.0*halfAnomaly);
+
+        // Vallado, Fundamentals of Astrodynamics and Applications, section 9.6.
+        auto keplerMotion = std::sqrt(mu/(double(a)*a*a));
+        auto ratio = double(radius0)/(a*(1.0 - ecc*ecc));
+        auto factor = 1.5*j20*ratio*ratio*keplerMotion;
+        auto sin2 = std::sin(double(inclination))*std::sin(double(inclination));
+        nodeRate = -factor*std::cos(double(inclination));
+        periapsisRate = factor*(2.0 - 2.5*sin2);
+        n = keplerMotion + factor*std::sqrt(1.0 - ecc*ecc)*(1.0 - 1.5*sin2);
+    }
+
+
+    template<typename ScalarType>
+    auto SecularJ2Propagator<ScalarType>::eccentricAnomaly(ScalarType meanAnomaly) const -> ScalarType
+    {
+        auto anomaly = meanAnomaly + e*std::sin(meanAnomaly);
+        for (auto iteration = 0; iteration < KeplerPropagator<ScalarType>::maxIterations; ++iteration) {
+            auto delta = (anomaly - e*std::sin(anomaly) - meanAnomaly)/(1 - e*std::cos(anomaly));
+            anomaly -= delta;
+            if (std::abs(delta) <= 4*std::numeric_limits<ScalarType>::epsilon()) break;
+        }
+        return anomaly;
+    }
+
+
+    template<typename ScalarType>
+    auto SecularJ2Propagator<ScalarType>::position(double t) const -> vector3
+    {
+        auto anomaly = eccentricAnomaly(ScalarType(std::remainder(meanAnomaly(t), 2.0*std::numbers::pi)));
+        vector3 perifocal{a*(std::cos(anomaly) - e), a*std::sqrt(1 - e*e)*std::sin(anomaly), 0};
+        return orientation(t).transform(perifocal);
+    }
+
+
+    template<typename ScalarType>
+    auto SecularJ2Propagator<ScalarType>::propagate(double t) const -> stateType
+    {
+        auto anomaly = eccentricAnomaly(ScalarType(std::remainder(meanAnomaly(t), 2.0*std::numbers::pi)));
+        auto cosE = std::cos(anomaly);
+        auto sinE = std::sin(anomaly);
+        auto b = a*std::sqrt(1 - e*e);
+        auto rate = ScalarType(n)/(1 - e*cosE);
+        auto toInertial = orientation(t);
+        // Turning of the node and periapsis adds only order J2 to the velocity and is left out.
+        return {toInertial.transform(vector3{a*(cosE - e), b*sinE, 0}),
+                toInertial.transform(vector3{-a*sinE*rate, b*cosE*rate, 0})};
+    }
+}
+
+#endif //ORBIT_PROPAGATOR_HPP
+#pragma clang diagnostic pop
@@ -0,0 +1,78 @@
+// -*- mode: c++ -*-
+////
+// Counter based random numbers.  Every draw is a pure function of (key, counter), so sample n comes out the same
+// no matter which thread generates it or in what order.
+//
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
+
+#ifndef ORBIT_RANDOM_HPP
+#define ORBIT_RANDOM_HPP
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+
+namespace numutil {
+    /**
+     * Philox4x32-10 of Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3", SC11.
+     * Maps a 128 bit counter and 64 bit key to 128 random bits.
+     */
+    class Philox4x32 {
+    public:
+        using counterType = std::array<std::uint32_t, 4>;
+        using keyType = std::array<std::uint32_t, 2>;
+
+        explicit Philox4x32(keyType key0) : key{key0} {}
+
+        /// Key from a 64 bit seed.
+        explicit Philox4x32(std::uint64_t seed)
+                : key{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)} {}
+
+        auto operator()(counterType counter) const -> counterType
+        {
+            auto k = key;
+            for (auto round = 0; round < 10; ++round) {
+                if (round > 0) {
+                    k[0] += 0x9E3779B9u;
+                    k[1] += 0xBB67AE85u;
+                }
+                auto product0 = std::uint64_t{0xD2511F53u}*counter[0];
+                auto product1 = std::uint64_t{0xCD9E8D57u}*counter[2];
+                counter = {static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ k[0],
+                           static_cast<std::uint32_t>(product1),
+                           static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ k[1],
+                           static_cast<std::uint32_t>(product0)};
+            }
+            return counter;
+        }
+
+        /// The 128 random bits for sample index and stream, as two 64 bit words.
+        auto words(std::uint64_t index, std::uint32_t stream) const -> std::array<std::uint64_t, 2>
+        {
+            auto bits = (*this)({static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(index >> 32),
+                                 stream, 0});
+            return {(std::uint64_t{bits[1]} << 32) | bits[0], (std::uint64_t{bits[3]} << 32) | bits[2]};
+        }
+
+        /// Map 64 random bits to [0, 1) with 53 bits of precision.
+        static auto uniform(std::uint64_t word) -> double { return static_cast<double>(word >> 11)*0x1.0p-53; }
+
+        /// Two independent standard normal deviates for index and stream by Box-Muller.
+        auto normal(std::uint64_t index, std::uint32_t stream) const -> std::array<double, 2>
+        {
+            auto w = words(index, stream);
+            auto radius = std::sqrt(-2.0*std::log(1.0 - uniform(w[0])));
+            auto angle = 2.0*std::numbers::pi*uniform(w[1]);
+            return {radius*std::cos(angle), radius*std::sin(angle)};
+        }
+
+    private:
+        keyType key;
+    };
+}
+
+#endif //ORBIT_RANDOM_HPP
+#pragma clang diagnostic pop
@@ -0,0 +1,82 @@
+// -*- mode: c++ -*-
+////
+// Bracketed scalar root finding and minimization for event detection.
+//
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
+
+#ifndef ORBIT_ROOTS_HPP
+#define ORBIT_ROOTS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace numutil {
+    /**
+     * Root of f in [a, b] by the Illinois variant of regula falsi, which keeps the bracket like bisection but
+     * converges superlinearly.  f(a) and f(b), already known to the caller, must differ in sign.
+     * @param tolerance Width of the final bracket.
+     * @return The end of the final bracket on the side of b.
+     */
+    template<typename Function>
+    auto findRoot(Function f, double a, double b, double fa, double fb, double tolerance, int maxIterations = 100)
+            -> double
+    {
+        auto side = 0;
+        for (auto iteration = 0; iteration < maxIterations && std::abs(b - a) > tolerance; ++iteration) {
+            auto c = (a*fb - b*fa)/(fb - fa);
+            // Keep the false position strictly inside and make progress even when it lands on an end.
+            if (!(c > std::min(a, b) && c < std::max(a, b))) c = (a + b)/2;
+            auto fc = f(c);
+            if (fc == 0) return c;
+            if ((fc < 0) == (fb < 0)) {
+                b = c;
+                fb = fc;
+                if (side == 1) fa /= 2;
+                side = 1;
+            } else {
+                a = c;
+                fa = fc;
+                if (side == -1) fb /= 2;
+                side = -1;
+            }
+        }
+        return b;
+    }
+
+
+    /**
+     * Minimum of a unimodal f on [a, b] by golden section search.
+     * @return The abscissa and value of the smallest sample.
+     */
+    template<typename Function>
+    auto minimize(Function f, double a, double b, double tolerance) -> std::pair<double, double>
+    {
+        const auto ratio = (std::sqrt(5.0) - 1)/2;
+        auto x1 = b - ratio*(b - a);
+        auto x2 = a + ratio*(b - a);
+        auto f1 = f(x1);
+        auto f2 = f(x2);
+        while (b - a > tolerance) {
+            if (f1 < f2) {
+                b = x2;
+                x2 = x1;
+                f2 = f1;
+                x1 = b - ratio*(b - a);
+                f1 = f(x1);
+            } else {
+                a = x1;
+                x1 = x2;
+                f1 = f2;
+                x2 = a + ratio*(b - a);
+                f2 = f(x2);
+            }
+        }
+        return f1 < f2 ? std::pair{x1, f1} : std::pair{x2, f2};
+    }
+}
+
+#endif //ORBIT_ROOTS_HPP
+#pragma clang diagnostic pop
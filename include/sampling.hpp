@@ -0,0 +1,154 @@
+// -*- mode: c++ -*-
+////
+// Lazily generated element grids and Monte Carlo dispersions of KeplerianElements, converted to state vectors and
+// reduced in parallel without ever holding the full sample set.
+//
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedStructInspection"
+#pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
+
+#ifndef ORBIT_SAMPLING_HPP
+#define ORBIT_SAMPLING_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "constants.hpp"
+#include "orbit.hpp"
+#include "parallel.hpp"
+#include "random.hpp"
+
+namespace orbit {
+    /// count evenly spaced values from first to last inclusive; a single value sits at first.
+    template<typename ScalarType>
+    struct GridAxis {
+        ScalarType first;
+        ScalarType last;
+        std::uint64_t count = 1;
+
+        auto operator[](std::uint64_t k) const -> ScalarType
+        { return count > 1 ? first + (last - first)*ScalarType(k)/ScalarType(count - 1) : first; }
+    };
+
+
+    /**
+     * Cartesian product of six element axes.  Sample n decodes n in mixed radix with true anomaly varying fastest,
+     * so any index is generated directly without the ones before it.
+     */
+    template<typename ScalarType>
+    class ElementGrid {
+    public:
+        using scalarType = ScalarType;
+        using axisType = GridAxis<ScalarType>;
+
+        /// Axes in the order a, e, i, right ascension of the ascending node, argument of periapsis, true anomaly.
+        ElementGrid(const std::array<axisType, 6> &axes0, ScalarType mu0 = orbit::muEarth) : axes{axes0}, mu{mu0} {}
+
+        auto size() const -> std::uint64_t
+        {
+            std::uint64_t n = 1;
+            for (const auto &axis: axes) n *= axis.count;
+            return n;
+        }
+
+        auto operator()(std::uint64_t index) const -> KeplerianElements<ScalarType>
+        {
+            ScalarType value[6];
+            for (auto k = 5; k >= 0; --k) {
+                value[k] = axes[k][index % axes[k].count];
+                index /= axes[k].count;
+            }
+            return {value[0], value[1], value[2], value[3], value[4], value[5], mu};
+        }
+
+    private:
+        std::array<axisType, 6> axes;
+        ScalarType mu;
+    };
+
+
+    /**
+     * Independent Gaussian dispersions of each element about a nominal orbit.  Sample n is a pure function of the
+     * seed and n, so results do not depend on thread count or scheduling.  Eccentricity is clamped to [0, 1).
+     */
+    template<typename ScalarType>
+    class ElementDispersion {
+    public:
+        using scalarType = ScalarType;
+
+        /// sigma holds the one-sigma dispersion of a, e, i, right ascension, argument of periapsis, true anomaly.
+        ElementDispersion(const KeplerianElements<ScalarType> &nominal, const std::array<ScalarType, 6> &sigma0,
+                          std::uint64_t count0, std::uint64_t seed = 0)
+                : mean{nominal.semiMajorAxis, nominal.eccentricity, nominal.inclination,
+                       nominal.rightAscensionAscendingNode, nominal.argumentOfPeriapsis, nominal.trueAnomaly},
+                  sigma{sigma0}, count{count0}, mu{nominal.gravitationalConstant()}, generator{seed} {}
+
+        auto size() const -> std::uint64_t { return count; }
+
+        auto operator()(std::uint64_t index) const -> KeplerianElements<ScalarType>
+        {
+            ScalarType value[6];
+            for (auto pair = 0u; pair < 3; ++pair) {
+                auto deviate = generator.normal(index, pair);
+                value[2*pair] = mean[2*pair] + sigma[2*pair]*ScalarType(deviate[0]);
+                value[2*pair + 1] = mean[2*pair + 1] + sigma[2*pair + 1]*ScalarType(deviate[1]);
+            }
+            value[1] = std::clamp(value[1], ScalarType(0), ScalarType(1) - std::numeric_limits<ScalarType>::epsilon());
+            return {value[0], value[1], value[2], value[3], value[4], value[5], mu};
+        }
+
+    private:
+        std::array<ScalarType, 6> mean;
+        std::array<ScalarType, 6> sigma;
+        std::uint64_t count;
+        ScalarType mu;
+        numutil::Philox4x32 generator;
+    };
+
+
+    /**
+     * Generate every sample of sampler, convert it to a StateVector and fold it into an accumulator, in parallel.
+     *
+     * Samples are processed in fixed chunks, each folded into its own copy of init; the chunk results are then
+     * merged in chunk order.  Memory is one accumulator per chunk rather than one state per sample, and because
+     * chunk boundaries do not depend on the number of workers the result is bit for bit reproducible.
+     * @param sampler ElementGrid, ElementDispersion or anything with size() and operator()(index).
+     * @param init Identity accumulator.
+     * @param accumulate Callable (Accumulator&, const KeplerianElements&, const StateVector&).
+     * @param merge Callable (Accumulator& into, const Accumulator& from).
+     * @param workers Number of threads, 0 for one per hardware thread.
+     * @param chunk Samples per chunk.
+     */
+    template<typename Sampler, typename Accumulator, typename Accumulate, typename Merge>
+    auto sampleReduce(const Sampler &sampler, const Accumulator &init, Accumulate accumulate, Merge merge,
+                      unsigned workers = 0, std::uint64_t chunk = 1u << 16) -> Accumulator
+    {
+        using scalarType = typename Sampler::scalarType;
+        auto count = sampler.size();
+        if (count == 0) return init;
+
+        std::vector<Accumulator> partial((count + chunk - 1)/chunk, init);
+        numutil::parallelFor(count, [&](std::size_t begin, std::size_t end, unsigned) {
+            // begin is a multiple of chunk, but a single worker is handed the whole range at once.
+            for (auto first = begin; first < end; first += chunk) {
+                auto &accumulator = partial[first/chunk];
+                auto last = std::min<std::uint64_t>(first + chunk, end);
+                for (auto index = first; index < last; ++index) {
+                    auto elements = sampler(index);
+                    StateVector<scalarType> state{elements};
+                    accumulate(accumulator, elements, state);
+                }
+            }
+        }, workers, chunk);
+
+        auto result = partial.front();
+        for (auto k = 1u; k < partial.size(); ++k) merge(result, partial[k]);
+        return result;
+    }
+}
+
+#endif //ORBIT_SAMPLING_HPP
+#pragma clang diagnostic pop
@@ -0,0 +1,398 @@
+// -*- mode: c++ -*-
+////
+// Spatial index over the paths of closed orbits for geometric screening: which orbits cross an altitude band, and
+// which can ever pass within some distance of a point.  A k-d tree over perigee radius, apogee radius and orbit
+// plane normal, each node also bounding its orbits' ellipses with a box, prunes whole subtrees so queries touch a
+// small part of the catalog instead of scanning it.
+//
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
+
+#ifndef ORBIT_SPATIAL_HPP
+#define ORBIT_SPATIAL_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "matrix3x3.hpp"
+#include "orbit.hpp"
+#include "roots.hpp"
+#include "vector3.hpp"
+
+namespace orbit {
+    /**
+     * Size, shape and orientation of a closed orbit: the ellipse the object travels, without its timing.
+     * @tparam ScalarType float or double.
+     */
+    template<typename ScalarType>
+    class OrbitGeometry {
+    public:
+        using vector3 = numutil::Vector3<ScalarType>;
+
+        /// Throws std::invalid_argument for open orbits, which have no bounded path.
+        explicit OrbitGeometry(const KeplerianElements<ScalarType> &);
+
+        auto perigeeRadius() const -> ScalarType { return semiMajorAxis - focalDistance; }
+
+        auto apogeeRadius() const -> ScalarType { return semiMajorAxis + focalDistance; }
+
+        /// Unit normal of the orbit plane, along the angular momentum.
+        auto normal() const -> const vector3 & { return w; }
+
+        /// Corner of the axis aligned box around the ellipse with the lowest (sign -1) or highest (+1) coordinates.
+        auto boxCorner(int sign) const -> vector3;
+
+        /// Smallest distance between point and any point of the orbit.
+        auto distanceTo(const vector3 &point) const -> ScalarType;
+
+    private:
+        ScalarType semiMajorAxis;
+        ScalarType semiMinorAxis;
+        ScalarType focalDistance;   // a e, from the center to the focus at the origin
+        vector3 p;                  // toward periapsis
+        vector3 q;                  // in plane, 90 degrees ahead of p
+        vector3 w;
+    };
+
+
+    /**
+     * Static k-d tree over a catalog of orbit geometries; rebuild it when the catalog changes.  Queries return
+     * catalog indices in increasing order.
+     * @tparam ScalarType float or double.
+     */
+    template<typename ScalarType>
+    class OrbitIndex {
+    public:
+        using vector3 = numutil::Vector3<ScalarType>;
+
+        /// Orbits per leaf.
+        static const auto leafSize = 16;
+
+        explicit OrbitIndex(std::span<const KeplerianElements<ScalarType>> catalog);
+
+        auto size() const -> std::size_t { return geometries.size(); }
+
+        /// Geometry of catalog entry id.
+        auto geometry(std::size_t id) const -> const OrbitGeometry<ScalarType> & { return geometries[slots[id]]; }
+
+        /// Orbits with some part between the two radii (meters from the center of the body), that is whose perigee
+        /// to apogee interval overlaps [innerRadius, outerRadius].
+        auto shell(ScalarType innerRadius, ScalarType outerRadius) const -> std::vector<std::size_t>;
+
+        /// Orbits whose path comes within distance of point.
+        auto near(const vector3 &point, ScalarType distance) const -> std::vector<std::size_t>;
+
+        /// Orbits and tree nodes the most recent query on this thread looked at, for judging pruning.
+        static auto lastVisited() -> std::pair<std::size_t, std::size_t> { return {visitedOrbits, visitedNodes}; }
+
+    private:
+        // Split features: perigee radius, apogee radius and the three components of the plane normal.
+        static const auto features = 5;
+
+        struct Node {
+            ScalarType low[features];
+            ScalarType high[features];
+            vector3 boxLow;
+            vector3 boxHigh;
+            std::uint32_t begin;
+            std::uint32_t end;
+            std::int32_t left;      // -1 for a leaf
+            std::int32_t right;
+        };
+
+        /// Split features and box of one orbit, computed once for the build.
+        struct Extent {
+            ScalarType feature[features];
+            vector3 boxLow;
+            vector3 boxHigh;
+        };
+
+        auto build(std::uint32_t begin, std::uint32_t end, const std::vector<Extent> &,
+                   const ScalarType (&scale)[features]) -> std::int32_t;
+
+        auto bound(Node &, const std::vector<Extent> &) const -> void;
+
+        /// Ids in increasing order; large results go through a bitmap, linear in the catalog rather than n log n.
+        auto sorted(std::vector<std::size_t> result) const -> std::vector<std::size_t>;
+
+        std::vector<OrbitGeometry<ScalarType>> geometries;  // in tree order
+        std::vector<std::size_t> ids;                       // catalog index of each tree slot
+        std::vector<std::size_t> slots;                     // tree slot of each catalog index
+        std::vector<Node> nodes;
+        static thread_local inline std::size_t visitedOrbits = 0;
+        static thread_local inline std::size_t visitedNodes = 0;
+    };
+
+
+    template<typename ScalarType>
+    OrbitGeometry<ScalarType>::OrbitGeometry(const KeplerianElements<ScalarType> &elements)
+            : semiMajorAxis{elements.semiMajorAxis},
+              semiMinorAxis{elements.semiMajorAxis*std::sqrt(1 - elements.eccentricity*elements.eccentricity)},
+              focalDistance{elements.semiMajorAxis*elements.eccentricity}
+    {
+        if (!(elements.eccentricity >= 0 && elements.eccentricity < 1 && elements.semiMajorAxis > 0)) {
+            throw std::invalid_argument{"OrbitGeometry: orbit is not closed"};
+        }
+        numutil::Matrix3x3<ScalarType> toInertial{elements.argumentOfPeriapsis, elements.inclination,
+                                                  elements.rightAscensionAscendingNode};
+        p = toInertial.transform(vector3{1, 0, 0});
+        q = toInertial.transform(vector3{0, 1, 0});
+        w = toInertial.transform(vector3{0, 0, 1});
+    }
+
+
+    template<typename ScalarType>
+    auto OrbitGeometry<ScalarType>::boxCorner(int sign) const -> vector3
+    {
+        // The ellipse is c + a cos E p + b sin E q, extending sqrt((a p_k)^2 + (b q_k)^2) either side of c.
+        vector3 corner;
+        for (auto k = 0; k < 3; ++k) {
+            auto halfWidth = std::hypot(semiMajorAxis*p[k], semiMinorAxis*q[k]);
+            corner[k] = -focalDistance*p[k] + ScalarType(sign)*halfWidth;
+        }
+        return corner;
+    }
+
+
+    template<typename ScalarType>
+    auto OrbitGeometry<ScalarType>::distanceTo(const vector3 &point) const -> ScalarType
+    {
+        // In plane coordinates about the center of the ellipse, the squared distance to the point at eccentric
+        // anomaly E is (x - a cos E)^2 + (y - b sin E)^2 + z^2, which can have two local minima.  Sample E, refine
+        // the bracket of every sampled local minimum, and take the least, so the wrong basin is never the answer.
+        double x = point.dot(p) + focalDistance;
+        double y = point.dot(q);
+        double z = point.dot(w);
+        double a = semiMajorAxis;
+        double b = semiMinorAxis;
+        auto planar = [=](double e) {
+            auto dx = x - a*std::cos(e);
+            auto dy = y - b*std::sin(e);
+            return dx*dx + dy*dy;
+        };
+        const auto samples = 32;
+        const auto step = 2.0*std::numbers::pi/samples;
+        double values[samples];
+        for (auto k = 0; k < samples; ++k) values[k] = planar(k*step);
+        auto least = std::numeric_limits<double>::infinity();
+        for (auto k = 0; k < samples; ++k) {
+            auto value = values[k];
+            if (value > values[(k + samples - 1) % samples] || value > values[(k + 1) % samples]) continue;
+            auto refined = numutil::minimize(planar, (k - 1)*step, (k + 1)*step, 1.0e-10);
+            least = std::min({least, value, refined.second});
+        }
+        return ScalarType(std::sqrt(least + z*z));
+    }
+
+
+    template<typename ScalarType>
+    OrbitIndex<ScalarType>::OrbitIndex(std::span<const KeplerianElements<ScalarType>> catalog)
+    {
+        if (catalog.size() >= std::numeric_limits<std::uint32_t>::max()) {
+            throw std::length_error{"OrbitIndex: catalog too large"};
+        }
+        geometries.reserve(catalog.size());
+        std::vector<Extent> extents;
+        extents.reserve(catalog.size());
+        for (const auto &elements: catalog) {
+            const auto &geometry = geometries.emplace_back(elements);
+            const auto &normal = geometry.normal();
+            extents.push_back({{geometry.perigeeRadius(), geometry.apogeeRadius(), normal[0], normal[1], normal[2]},
+                               geometry.boxCorner(-1), geometry.boxCorner(1)});
+        }
+        ids.resize(catalog.size());
+        for (std::size_t k = 0; k < ids.size(); ++k) ids[k] = k;
+        if (geometries.empty()) return;
+
+        // Split on the feature widest relative to its extent over the whole catalog, so meters and unit normals
+        // compete evenly.
+        Node root{};
+        root.begin = 0;
+        root.end = static_cast<std::uint32_t>(geometries.size());
+        bound(root, extents);
+        ScalarType scale[features];
+        for (auto k = 0; k < features; ++k) {
+            auto extent = root.high[k] - root.low[k];
+            scale[k] = extent > 0 ? 1/extent : 0;
+        }
+        nodes.reserve(4*geometries.size()/leafSize + 1);
+        build(0, root.end, extents, scale);
+
+        // Store the geometries in tree order so leaves read contiguous memory.
+        std::vector<OrbitGeometry<ScalarType>> ordered;
+        ordered.reserve(geometries.size());
+        slots.resize(ids.size());
+        for (std::size_t slot = 0; slot < ids.size(); ++slot) {
+            ordered.push_back(geometries[ids[slot]]);
+            slots[ids[slot]] = slot;
+        }
+        geometries.swap(ordered);
+    }
+
+
+    template<typename ScalarType>
+    auto OrbitIndex<ScalarType>::bound(Node &node, const std::vector<Extent> &extents) const -> void
+    {
+        for (auto k = 0; k < features; ++k) {
+            node.low[k] = std::numeric_limits<ScalarType>::max();
+            node.high[k] = std::numeric_limits<ScalarType>::lowest();
+        }
+        for (auto k = 0; k < 3; ++k) {
+            node.boxLow[k] = std::numeric_limits<ScalarType>::max();
+            node.boxHigh[k] = std::numeric_limits<ScalarType>::lowest();
+        }
+        for (auto slot = node.begin; slot < node.end; ++slot) {
+            const auto &extent = extents[ids[slot]];
+            for (auto k = 0; k < features; ++k) {
+                node.low[k] = std::min(node.low[k], extent.feature[k]);
+                node.high[k] = std::max(node.high[k], extent.feature[k]);
+            }
+            for (auto k = 0; k < 3; ++k) {
+                node.boxLow[k] = std::min(node.boxLow[k], extent.boxLow[k]);
+                node.boxHigh[k] = std::max(node.boxHigh[k], extent.boxHigh[k]);
+            }
+        }
+    }
+
+
+    template<typename ScalarType>
+    auto OrbitIndex<ScalarType>::build(std::uint32_t begin, std::uint32_t end, const std::vector<Extent> &extents,
+                                       const ScalarType (&scale)[features]) -> std::int32_t
+    {
+        auto index = static_cast<std::int32_t>(nodes.size());
+        nodes.push_back(Node{});
+        auto &node = nodes.back();
+        node.begin = begin;
+        node.end = end;
+        node.left = node.right = -1;
+        bound(node, extents);
+        if (end - begin <= std::uint32_t(leafSize)) return index;
+
+        auto axis = 0;
+        for (auto k = 1; k < features; ++k) {
+            if ((node.high[k] - node.low[k])*scale[k] > (node.high[axis] - node.low[axis])*scale[axis]) axis = k;
+        }
+        auto middle = begin + (end - begin)/2;
+        std::nth_element(ids.begin() + begin, ids.begin() + middle, ids.begin() + end,
+                         [&](std::size_t i, std::size_t j) {
+                             return extents[i].feature[axis] < extents[j].feature[axis];
+                         });
+        // node may move as children are appended; write through the index.
+        auto left = build(begin, middle, extents, scale);
+        auto right = build(middle, end, extents, scale);
+        nodes[index].left = left;
+        nodes[index].right = right;
+        return index;
+    }
+
+
+    template<typename ScalarType>
+    auto OrbitIndex<ScalarType>::sorted(std::vector<std::size_t> result) const -> std::vector<std::size_t>
+    {
+        if (result.size() < geometries.size()/64) {
+            std::sort(result.begin(), result.end());
+            return result;
+        }
+        std::vector<std::uint64_t> marks((geometries.size() + 63)/64, 0);
+        for (auto id: result) marks[id/64] |= std::uint64_t(1) << (id % 64);
+        result.clear();
+        for (std::size_t word = 0; word < marks.size(); ++word) {
+            for (auto bits = marks[word]; bits != 0; bits &= bits - 1) {
+                result.push_back(word*64 + std::size_t(std::countr_zero(bits)));
+            }
+        }
+        return result;
+    }
+
+
+    template<typename ScalarType>
+    auto OrbitIndex<ScalarType>::shell(ScalarType innerRadius, ScalarType outerRadius) const
+            -> std::vector<std::size_t>
+    {
+        std::vector<std::size_t> result;
+        visitedOrbits = visitedNodes = 0;
+        if (nodes.empty()) return result;
+        std::vector<std::int32_t> stack{0};
+        while (!stack.empty()) {
+            const auto &node = nodes[stack.back()];
+            stack.pop_back();
+            ++visitedNodes;
+            if (node.low[0] > outerRadius || node.high[1] < innerRadius) continue;
+            if (node.high[0] <= outerRadius && node.low[1] >= innerRadius) {
+                // Every orbit below overlaps the band.
+                result.insert(result.end(), ids.begin() + node.begin, ids.begin() + node.end);
+                continue;
+            }
+            if (node.left >= 0) {
+                stack.push_back(node.left);
+                stack.push_back(node.right);
+                continue;
+            }
+            for (auto slot = node.begin; slot < node.end; ++slot) {
+                ++visitedOrbits;
+                const auto &geometry = geometries[slot];
+                if (geometry.perigeeRadius() <= outerRadius && geometry.apogeeRadius() >= innerRadius) {
+                    result.push_back(ids[slot]);
+                }
+            }
+        }
+        return sorted(std::move(result));
+    }
+
+
+    template<typename ScalarType>
+    auto OrbitIndex<ScalarType>::near(const vector3 &point, ScalarType distance) const -> std::vector<std::size_t>
+    {
+        std::vector<std::size_t> result;
+        visitedOrbits = visitedNodes = 0;
+        if (nodes.empty()) return result;
+        auto radius = point.norm();
+        std::vector<std::int32_t> stack{0};
+        while (!stack.empty()) {
+            const auto &node = nodes[stack.back()];
+            stack.pop_back();
+            ++visitedNodes;
+
+            // Radial band, then the range of heights above the orbit planes over the node's normals, then the box.
+            if (node.low[0] > radius + distance || node.high[1] < radius - distance) continue;
+            ScalarType heightLow = 0, heightHigh = 0, boxGap = 0;
+            for (auto k = 0; k < 3; ++k) {
+                auto a = node.low[k + 2]*point[k];
+                auto b = node.high[k + 2]*point[k];
+                heightLow += std::min(a, b);
+                heightHigh += std::max(a, b);
+                auto gap = std::max({node.boxLow[k] - point[k], point[k] - node.boxHigh[k], ScalarType(0)});
+                boxGap += gap*gap;
+            }
+            if (heightLow > distance || heightHigh < -distance || boxGap > distance*distance) continue;
+
+            if (node.left >= 0) {
+                stack.push_back(node.left);
+                stack.push_back(node.right);
+                continue;
+            }
+            for (auto slot = node.begin; slot < node.end; ++slot) {
+                ++visitedOrbits;
+                const auto &geometry = geometries[slot];
+                if (geometry.perigeeRadius() > radius + distance || geometry.apogeeRadius() < radius - distance
+                    || std::abs(geometry.normal().dot(point)) > distance) {
+                    continue;
+                }
+                if (geometry.distanceTo(point) <= distance) result.push_back(ids[slot]);
+            }
+        }
+        return sorted(std::move(result));
+    }
+}
+
+#endif //ORBIT_SPATIAL_HPP
+#pragma clang diagnostic pop
@@ -0,0 +1,15 @@
+// -*- mode: c++ -*-
+////
+// Specializations for the asynchronous batch front end.
+//
+#include "async.hpp"
+
+template class numutil::BatchState<orbit::StateVector<float>>;
+template class numutil::BatchState<orbit::StateVector<double>>;
+template class numutil::BatchState<orbit::KeplerianElements<float>>;
+template class numutil::BatchState<orbit::KeplerianElements<double>>;
+
+template class numutil::BatchResult<orbit::StateVector<float>>;
+template class numutil::BatchResult<orbit::StateVector<double>>;
+template class numutil::BatchResult<orbit::KeplerianElements<float>>;
+template class numutil::BatchResult<orbit::KeplerianElements<double>>;
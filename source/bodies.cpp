@@ -0,0 +1,23 @@
+// -*- mode: c++ -*-
+////
+// Specializations for the compile time central bodies.
+//
+#include "bodies.hpp"
+
+template struct orbit::BodyElements<orbit::Earth, float>;
+template struct orbit::BodyElements<orbit::Earth, double>;
+template struct orbit::BodyElements<orbit::Moon, float>;
+template struct orbit::BodyElements<orbit::Moon, double>;
+template struct orbit::BodyElements<orbit::Mars, float>;
+template struct orbit::BodyElements<orbit::Mars, double>;
+template struct orbit::BodyElements<orbit::Sun, float>;
+template struct orbit::BodyElements<orbit::Sun, double>;
+
+template class orbit::KeplerPropagator<float, orbit::BodyGravity<orbit::Earth, float>>;
+template class orbit::KeplerPropagator<double, orbit::BodyGravity<orbit::Earth, double>>;
+template class orbit::KeplerPropagator<float, orbit::BodyGravity<orbit::Moon, float>>;
+template class orbit::KeplerPropagator<double, orbit::BodyGravity<orbit::Moon, double>>;
+template class orbit::KeplerPropagator<float, orbit::BodyGravity<orbit::Mars, float>>;
+template class orbit::KeplerPropagator<double, orbit::BodyGravity<orbit::Mars, double>>;
+template class orbit::KeplerPropagator<float, orbit::BodyGravity<orbit::Sun, float>>;
+template class orbit::KeplerPropagator<double, orbit::BodyGravity<orbit::Sun, double>>;
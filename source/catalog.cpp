@@ -0,0 +1,8 @@
+// -*- mode: c++ -*-
+////
+// Specializations for the incremental catalog.
+//
+#include "catalog.hpp"
+
+template class orbit::IncrementalCatalog<float>;
+template class orbit::IncrementalCatalog<double>;
@@ -0,0 +1,191 @@
+// -*- mode: c++ -*-
+////
+// Footprint rasterization, merging and statistics for coverage grids, and specializations of the coverage driver.
+//
+#include "coverage.hpp"
+
+namespace orbit {
+    namespace {
+        /// Rows of a grid of resolution degrees.
+        auto rowsFor(double resolution) -> std::size_t
+        {
+            if (!(resolution > 0) || resolution > 90) throw std::invalid_argument{"CoverageGrid: bad resolution"};
+            auto rows = std::llround(180.0/resolution);
+            if (std::abs(double(rows)*resolution - 180.0) > 1.0e-9) {
+                throw std::invalid_argument{"CoverageGrid: resolution must divide 180 degrees"};
+            }
+            return std::size_t(rows);
+        }
+    }
+
+
+    auto CoverageGrid::storageBytes(double resolution, std::size_t tileSize) -> std::size_t
+    {
+        auto rows = rowsFor(resolution);
+        auto tile = std::max<std::size_t>(1, tileSize);
+        return ((rows + tile - 1)/tile)*((2*rows + tile - 1)/tile)*tile*tile*sizeof(CoverageCell);
+    }
+
+
+    CoverageGrid::CoverageGrid(double resolution0, std::size_t tileSize0)
+            : resolutionDegrees{resolution0}, tile{std::max<std::size_t>(1, tileSize0)}, rowCount{rowsFor(resolution0)},
+              columnCount{2*rowCount}
+    {
+        auto tilesDown = (rowCount + tile - 1)/tile;
+        auto tilesAcross = (columnCount + tile - 1)/tile;
+        const auto cellAngle = resolutionDegrees*std::numbers::pi/180.0;
+        for (std::size_t row = 0; row < rowCount; ++row) {
+            rowOffsets.push_back((row/tile)*tilesAcross*tile*tile + (row % tile)*tile);
+            auto latitude = -std::numbers::pi/2 + (double(row) + 0.5)*cellAngle;
+            rowSines.push_back(std::sin(latitude));
+            rowCosines.push_back(std::cos(latitude));
+        }
+        for (std::size_t column = 0; column < columnCount; ++column) {
+            columnOffsets.push_back((column/tile)*tile*tile + column % tile);
+        }
+        cells.resize(tilesDown*tilesAcross*tile*tile);
+    }
+
+
+    auto CoverageGrid::mark(CoverageCell &cell, std::int32_t step) -> void
+    {
+        if (cell.last == step) return;
+        if (cell.last != step - 1) {
+            if (cell.first == CoverageCell::never) {
+                cell.first = step;
+            } else {
+                auto gap = std::uint32_t(step - cell.last - 1);
+                ++cell.gaps;
+                cell.gapSum += gap;
+                cell.gapMax = std::max(cell.gapMax, gap);
+            }
+            cell.lastStart = step;
+        }
+        cell.last = step;
+        ++cell.covered;
+    }
+
+
+    auto CoverageGrid::add(double latitude, double longitude, double angle, std::int32_t step) -> void
+    {
+        const auto pi = std::numbers::pi;
+        const auto cellAngle = resolutionDegrees*pi/180.0;
+        const auto columns = static_cast<long>(columnCount);
+        auto sinLatitude = std::sin(latitude);
+        auto cosLatitude = std::cos(latitude);
+        auto cosAngle = std::cos(angle);
+        auto width = tile > 1 ? tile : columnCount;
+
+        // Rows whose centers are within angle in latitude, then on each the longitudes within angle on the sphere.
+        auto low = std::max(0l, static_cast<long>(std::ceil((latitude - angle + pi/2)/cellAngle - 0.5)));
+        auto high = std::min(static_cast<long>(rowCount) - 1,
+                             static_cast<long>(std::floor((latitude + angle + pi/2)/cellAngle - 0.5)));
+        for (auto row = low; row <= high; ++row) {
+            auto numerator = cosAngle - rowSines[row]*sinLatitude;
+            auto denominator = rowCosines[row]*cosLatitude;
+            if (numerator > denominator) continue;
+            auto halfWidth = numerator <= -denominator ? pi : std::acos(numerator/denominator);
+
+            auto first = static_cast<long>(std::ceil((longitude - halfWidth + pi)/cellAngle - 0.5));
+            auto last = static_cast<long>(std::floor((longitude + halfWidth + pi)/cellAngle - 0.5));
+            if (last - first + 1 >= columns) {
+                first = 0;
+                last = columns - 1;
+            }
+            auto base = cells.data() + rowOffsets[row];
+            // Columns within one tile, or the whole row when untiled, are adjacent in memory.
+            auto run = [&](long from, long to) {
+                while (from <= to) {
+                    auto stop = std::min(to + 1, static_cast<long>((std::size_t(from)/width + 1)*width));
+                    auto cell = base + columnOffsets[from];
+                    for (auto end = cell + (stop - from); cell != end; ++cell) mark(*cell, step);
+                    from = stop;
+                }
+            };
+            if (first < 0) {
+                run(first + columns, columns - 1);
+                run(0, last);
+            } else if (last >= columns) {
+                run(first, columns - 1);
+                run(0, last - columns);
+            } else {
+                run(first, last);
+            }
+        }
+    }
+
+
+    auto CoverageGrid::merge(const CoverageGrid &later, unsigned workers) -> void
+    {
+        if (later.rowCount != rowCount || later.tile != tile) {
+            throw std::invalid_argument{"CoverageGrid::merge: grids differ in resolution or tiling"};
+        }
+        numutil::parallelFor(cells.size(), [&](std::size_t begin, std::size_t end, unsigned) {
+            for (auto k = begin; k < end; ++k) {
+                auto &cell = cells[k];
+                const auto &next = later.cells[k];
+                if (next.first == CoverageCell::never) continue;
+                if (cell.first == CoverageCell::never) {
+                    cell = next;
+                    continue;
+                }
+                if (next.first != cell.last + 1) {
+                    auto gap = std::uint32_t(next.first - cell.last - 1);
+                    ++cell.gaps;
+                    cell.gapSum += gap;
+                    cell.gapMax = std::max(cell.gapMax, gap);
+                    cell.lastStart = next.lastStart;
+                } else if (next.gaps > 0) {
+                    // The access running across the boundary is not the last one.
+                    cell.lastStart = next.lastStart;
+                }
+                cell.gaps += next.gaps;
+                cell.gapSum += next.gapSum;
+                cell.gapMax = std::max(cell.gapMax, next.gapMax);
+                cell.covered += next.covered;
+                cell.last = next.last;
+            }
+        }, workers);
+    }
+
+
+    auto CoverageGrid::statistics(std::int32_t steps, double step) const -> CoverageStatistics
+    {
+        const auto cellAngle = resolutionDegrees*std::numbers::pi/180.0;
+        CoverageStatistics result;
+        double total = 0, revisitedArea = 0;
+        for (std::size_t row = 0; row < rowCount; ++row) {
+            // Cell area is proportional to the difference of the sines of its bounding latitudes.
+            auto bottom = -std::numbers::pi/2 + double(row)*cellAngle;
+            auto area = std::sin(bottom + cellAngle) - std::sin(bottom);
+            for (std::size_t column = 0; column < columnCount; ++column) {
+                const auto &cell = cells[rowOffsets[row] + columnOffsets[column]];
+                total += area;
+                if (cell.first == CoverageCell::never) continue;
+                result.coverage += area;
+                result.timeCoverage += area*double(cell.covered)/double(steps);
+                if (cell.gaps == 0) continue;
+                revisitedArea += area;
+                result.meanRevisit += area*double(cell.lastStart - cell.first)/double(cell.gaps);
+                result.meanGap += area*double(cell.gapSum)/double(cell.gaps);
+                result.meanMaxGap += area*double(cell.gapMax);
+                result.maxGap = std::max(result.maxGap, double(cell.gapMax));
+            }
+        }
+        result.coverage /= total;
+        result.timeCoverage /= total;
+        result.revisited = revisitedArea/total;
+        if (revisitedArea > 0) {
+            result.meanRevisit *= step/revisitedArea;
+            result.meanGap *= step/revisitedArea;
+            result.meanMaxGap *= step/revisitedArea;
+        }
+        result.maxGap *= step;
+        return result;
+    }
+}
+
+template auto orbit::computeCoverage<float>(std::span<const SecularJ2Propagator<float>>, const Sensor &, double,
+                                            double, double, double, unsigned, std::size_t, std::size_t) -> CoverageReport;
+template auto orbit::computeCoverage<double>(std::span<const SecularJ2Propagator<double>>, const Sensor &, double,
+                                             double, double, double, unsigned, std::size_t, std::size_t) -> CoverageReport;
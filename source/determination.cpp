@@ -0,0 +1,19 @@
+// -*- mode: c++ -*-
+////
+// Specializations for orbit determination.
+//
+#include "determination.hpp"
+
+template class orbit::BatchLeastSquares<float>;
+template class orbit::BatchLeastSquares<double>;
+
+template auto orbit::gibbs(const numutil::Vector3<float>&, const numutil::Vector3<float>&,
+                           const numutil::Vector3<float>&, float) -> StateVector<float>;
+template auto orbit::gibbs(const numutil::Vector3<double>&, const numutil::Vector3<double>&,
+                           const numutil::Vector3<double>&, double) -> StateVector<double>;
+
+template auto orbit::herrickGibbs(const numutil::Vector3<float>&, const numutil::Vector3<float>&,
+                                  const numutil::Vector3<float>&, float, float, float, float) -> StateVector<float>;
+template auto orbit::herrickGibbs(const numutil::Vector3<double>&, const numutil::Vector3<double>&,
+                                  const numutil::Vector3<double>&, double, double, double, double)
+                                  -> StateVector<double>;
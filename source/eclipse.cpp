@@ -0,0 +1,8 @@
+// -*- mode: c++ -*-
+////
+// Specializations for shadow event detection.
+//
+#include "eclipse.hpp"
+
+template class orbit::EclipseFinder<float>;
+template class orbit::EclipseFinder<double>;
@@ -0,0 +1,8 @@
+// -*- mode: c++ -*-
+////
+// Specializations for the Sun and Moon ephemeris cache.
+//
+#include "ephemeris.hpp"
+
+template class orbit::EphemerisCache<float>;
+template class orbit::EphemerisCache<double>;
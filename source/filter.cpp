@@ -0,0 +1,15 @@
+// -*- mode: c++ -*-
+////
+// Specializations for the tracking filters.
+//
+#include "filter.hpp"
+
+template class orbit::ExtendedKalmanFilter<float>;
+template class orbit::ExtendedKalmanFilter<double>;
+template class orbit::ExtendedKalmanFilter<float, orbit::J2Propagator<float>>;
+template class orbit::ExtendedKalmanFilter<double, orbit::J2Propagator<double>>;
+
+template class orbit::UnscentedKalmanFilter<float>;
+template class orbit::UnscentedKalmanFilter<double>;
+template class orbit::UnscentedKalmanFilter<float, orbit::J2Propagator<float>>;
+template class orbit::UnscentedKalmanFilter<double, orbit::J2Propagator<double>>;
@@ -0,0 +1,11 @@
+// -*- mode: c++ -*-
+////
+// Specializations for the spherical harmonic gravity field.
+//
+#include "gravity.hpp"
+
+template class orbit::GravityWorkspace<float>;
+template class orbit::GravityWorkspace<double>;
+
+template class orbit::GravityField<float>;
+template class orbit::GravityField<double>;
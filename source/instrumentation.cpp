@@ -0,0 +1,262 @@
+// -*- mode: c++ -*-
+////
+// Per-thread counter storage and snapshot export for the instrumentation probes.
+//
+#include "instrumentation.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace orbit::instrumentation {
+    namespace {
+        using counter = std::atomic<std::uint64_t>;
+
+        /// Single writer counters.  Relaxed load and store instead of fetch_add keeps the writer free of locked
+        /// instructions while letting snapshot() read concurrently; no other thread ever writes them.
+        struct ThreadCounters {
+            struct Probe {
+                counter calls{0};
+                counter nanoseconds{0};
+                counter nonFinite{0};
+                std::array<counter, latencyBuckets> latency{};
+            };
+            std::array<Probe, probeCount> probes{};
+            std::array<counter, iterationBuckets> keplerIterations{};
+        };
+
+        auto bump(counter &c, std::uint64_t amount = 1) -> void
+        { c.store(c.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed); }
+
+        auto accumulate(Snapshot &total, const ThreadCounters &counters) -> void
+        {
+            for (auto p = 0; p < probeCount; ++p) {
+                const auto &from = counters.probes[p];
+                auto &to = total.probes[p];
+                to.calls += from.calls.load(std::memory_order_relaxed);
+                to.nanoseconds += from.nanoseconds.load(std::memory_order_relaxed);
+                to.nonFinite += from.nonFinite.load(std::memory_order_relaxed);
+                for (auto k = 0; k < latencyBuckets; ++k) to.latency[k] += from.latency[k].load(std::memory_order_relaxed);
+            }
+            for (auto k = 0; k < iterationBuckets; ++k) {
+                total.keplerIterations[k] += counters.keplerIterations[k].load(std::memory_order_relaxed);
+            }
+        }
+
+        auto subtract(Snapshot &total, const Snapshot &baseline) -> void
+        {
+            for (auto p = 0; p < probeCount; ++p) {
+                const auto &from = baseline.probes[p];
+                auto &to = total.probes[p];
+                to.calls -= from.calls;
+                to.nanoseconds -= from.nanoseconds;
+                to.nonFinite -= from.nonFinite;
+                for (auto k = 0; k < latencyBuckets; ++k) to.latency[k] -= from.latency[k];
+            }
+            for (auto k = 0; k < iterationBuckets; ++k) total.keplerIterations[k] -= baseline.keplerIterations[k];
+        }
+
+        /// Live threads' counters, the totals of threads that have exited, and the totals at the last reset.
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<ThreadCounters>> live;
+            Snapshot retired;
+            Snapshot baseline;
+
+            /// Everything recorded since the process started; the caller holds the mutex.
+            auto totals() const -> Snapshot
+            {
+                auto total = retired;
+                for (const auto &counters: live) accumulate(total, *counters);
+                return total;
+            }
+        };
+
+        auto registry() -> Registry &
+        {
+            static Registry instance;
+            return instance;
+        }
+
+        /// Registers this thread's counters on first use and folds them into the retired totals at thread exit.
+        struct ThreadHandle {
+            std::shared_ptr<ThreadCounters> counters = std::make_shared<ThreadCounters>();
+
+            ThreadHandle()
+            {
+                auto &r = registry();
+                std::lock_guard lock{r.mutex};
+                r.live.push_back(counters);
+            }
+
+            ~ThreadHandle()
+            {
+                auto &r = registry();
+                std::lock_guard lock{r.mutex};
+                accumulate(r.retired, *counters);
+                std::erase(r.live, counters);
+            }
+        };
+
+        auto local() -> ThreadCounters &
+        {
+            thread_local ThreadHandle handle;
+            return *handle.counters;
+        }
+    }
+
+
+    auto enabled() -> bool
+    {
+#ifdef ORBIT_INSTRUMENTATION
+        return true;
+#else
+        return false;
+#endif
+    }
+
+
+    auto probeName(Probe probe) -> const char *
+    {
+        switch (probe) {
+            case Probe::stateFromElements: return "state_from_elements";
+            case Probe::elementsFromState: return "elements_from_state";
+            case Probe::keplerPropagate: return "kepler_propagate";
+            case Probe::keplerPartials: return "kepler_partials";
+            case Probe::j2Propagate: return "j2_propagate";
+            case Probe::j2Partials: return "j2_partials";
+            default: return "unknown";
+        }
+    }
+
+
+    auto recordCall(Probe probe, std::uint64_t nanoseconds) -> void
+    {
+        auto &counters = local().probes[static_cast<int>(probe)];
+        bump(counters.calls);
+        bump(counters.nanoseconds, nanoseconds);
+        auto bucket = 0;
+        while (nanoseconds >>= 1) ++bucket;
+        bump(counters.latency[std::min(bucket, latencyBuckets - 1)]);
+    }
+
+
+    auto recordNonFinite(Probe probe) -> void
+    { bump(local().probes[static_cast<int>(probe)].nonFinite); }
+
+
+    auto recordKeplerIterations(int iterations) -> void
+    { bump(local().keplerIterations[std::clamp(iterations, 0, iterationBuckets - 1)]); }
+
+
+    auto snapshot() -> Snapshot
+    {
+        auto &r = registry();
+        std::lock_guard lock{r.mutex};
+        auto total = r.totals();
+        subtract(total, r.baseline);
+        total.enabled = enabled();
+        return total;
+    }
+
+
+    auto reset() -> void
+    {
+        auto &r = registry();
+        std::lock_guard lock{r.mutex};
+        r.baseline = r.totals();
+    }
+
+
+    auto toJson(const Snapshot &s) -> std::string
+    {
+        std::ostringstream out;
+        auto list = [&out](const auto &values) {
+            out << "[";
+            for (auto k = 0u; k < values.size(); ++k) out << (k > 0 ? "," : "") << values[k];
+            out << "]";
+        };
+
+        out << "{\"enabled\":" << (s.enabled ? "true" : "false") << ",\"probes\":{";
+        for (auto p = 0; p < probeCount; ++p) {
+            const auto &probe = s.probes[p];
+            out << (p > 0 ? "," : "") << "\"" << probeName(static_cast<Probe>(p)) << "\":{"
+                << "\"calls\":" << probe.calls
+                << ",\"nanoseconds\":" << probe.nanoseconds
+                << ",\"non_finite\":" << probe.nonFinite
+                << ",\"latency_log2_ns\":";
+            list(probe.latency);
+            out << "}";
+        }
+        out << "},\"kepler_iterations\":";
+        list(s.keplerIterations);
+        out << "}";
+        return out.str();
+    }
+
+
+    auto toPrometheus(const Snapshot &s) -> std::string
+    {
+        std::ostringstream out;
+        out.precision(17);
+        auto label = [](int p) { return std::string{"{probe=\""} + probeName(static_cast<Probe>(p)) + "\""; };
+
+        out << "# HELP orbit_calls_total Calls of each instrumented entry point.\n"
+            << "# TYPE orbit_calls_total counter\n";
+        for (auto p = 0; p < probeCount; ++p) out << "orbit_calls_total" << label(p) << "} " << s.probes[p].calls << "\n";
+
+        out << "# HELP orbit_non_finite_total Calls returning NaN or infinite results.\n"
+            << "# TYPE orbit_non_finite_total counter\n";
+        for (auto p = 0; p < probeCount; ++p) {
+            out << "orbit_non_finite_total" << label(p) << "} " << s.probes[p].nonFinite << "\n";
+        }
+
+        out << "# HELP orbit_latency_seconds Wall time per call.\n"
+            << "# TYPE orbit_latency_seconds histogram\n";
+        for (auto p = 0; p < probeCount; ++p) {
+            const auto &probe = s.probes[p];
+            std::uint64_t cumulative = 0;
+            for (auto k = 0; k < latencyBuckets - 1; ++k) {
+                cumulative += probe.latency[k];
+                out << "orbit_latency_seconds_bucket" << label(p) << ",le=\"" << static_cast<double>(2ull << k)*1.0e-9
+                    << "\"} " << cumulative << "\n";
+            }
+            out << "orbit_latency_seconds_bucket" << label(p) << ",le=\"+Inf\"} " << probe.calls << "\n"
+                << "orbit_latency_seconds_sum" << label(p) << "} " << static_cast<double>(probe.nanoseconds)*1.0e-9 << "\n"
+                << "orbit_latency_seconds_count" << label(p) << "} " << probe.calls << "\n";
+        }
+
+        out << "# HELP orbit_kepler_iterations Iterations needed to solve Kepler's equation.\n"
+            << "# TYPE orbit_kepler_iterations histogram\n";
+        std::uint64_t cumulative = 0;
+        double sum = 0;
+        for (auto k = 0; k < iterationBuckets - 1; ++k) {
+            cumulative += s.keplerIterations[k];
+            sum += static_cast<double>(k*s.keplerIterations[k]);
+            out << "orbit_kepler_iterations_bucket{le=\"" << k << "\"} " << cumulative << "\n";
+        }
+        cumulative += s.keplerIterations[iterationBuckets - 1];
+        sum += static_cast<double>((iterationBuckets - 1)*s.keplerIterations[iterationBuckets - 1]);
+        out << "orbit_kepler_iterations_bucket{le=\"+Inf\"} " << cumulative << "\n"
+            << "orbit_kepler_iterations_sum " << sum << "\n"
+            << "orbit_kepler_iterations_count " << cumulative << "\n";
+        return out.str();
+    }
+
+
+    auto writeFile(const std::string &path, const std::string &text) -> bool
+    {
+        auto temporary = path + ".tmp";
+        {
+            std::ofstream out{temporary, std::ios::trunc};
+            out << text;
+            if (!out.flush()) return false;
+        }
+        return std::rename(temporary.c_str(), path.c_str()) == 0;
+    }
+}
@@ -0,0 +1,8 @@
+// -*- mode: c++ -*-
+////
+// Specializations for the third body and solar radiation pressure models.
+//
+#include "perturbations.hpp"
+
+template class orbit::LuniSolarForce<float>;
+template class orbit::LuniSolarForce<double>;
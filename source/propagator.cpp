@@ -0,0 +1,17 @@
+// -*- mode: c++ -*-
+////
+// Specializations for the two-body propagator.
+//
+#include "propagator.hpp"
+
+template class orbit::UniversalFunctions<float>;
+template class orbit::UniversalFunctions<double>;
+
+template class orbit::KeplerPropagator<float>;
+template class orbit::KeplerPropagator<double>;
+
+template class orbit::J2Propagator<float>;
+template class orbit::J2Propagator<double>;
+
+template class orbit::SecularJ2Propagator<float>;
+template class orbit::SecularJ2Propagator<double>;
@@ -0,0 +1,14 @@
+// -*- mode: c++ -*-
+////
+// Specializations for the element samplers.
+//
+#include "sampling.hpp"
+
+template struct orbit::GridAxis<float>;
+template struct orbit::GridAxis<double>;
+
+template class orbit::ElementGrid<float>;
+template class orbit::ElementGrid<double>;
+
+template class orbit::ElementDispersion<float>;
+template class orbit::ElementDispersion<double>;
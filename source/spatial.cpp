@@ -0,0 +1,11 @@
+// -*- mode: c++ -*-
+////
+// Specializations for the orbit geometry index.
+//
+#include "spatial.hpp"
+
+template class orbit::OrbitGeometry<float>;
+template class orbit::OrbitGeometry<double>;
+
+template class orbit::OrbitIndex<float>;
+template class orbit::OrbitIndex<double>;
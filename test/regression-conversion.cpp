@@ -0,0 +1,236 @@
+// -*- mode: c++ -*-
+////
+// Accuracy and throughput regression of the KeplerianElements <-> StateVector conversions over dense grids of
+// eccentricity, inclination and node, in float and double, against baselines kept in the repository.
+//
+//  usage: regression-conversion baseline-file [--update] [--check-rates] [--error-factor f] [--time-tolerance t]
+//
+// Fails when an error statistic exceeds f times its baseline (default 4), or, with --check-rates, when a rate falls
+// more than the fraction t below its baseline (default 0.5).  Rates belong to the machine that recorded them, so
+// they are only checked on request and in optimized (NDEBUG) builds; otherwise they are just reported.  After a
+// deliberate change, or on a new reference machine, rerun with --update and commit the baseline file.
+//
+// Part of the orbit test suite
+//
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <numbers>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "orbit.hpp"
+#include "sampling.hpp"
+
+using namespace orbit;
+
+namespace {
+    using Measurements = std::vector<std::pair<std::string, double>>;
+
+    struct ErrorStatistics {
+        std::uint64_t count = 0;
+        std::uint64_t elementCount = 0;
+        double positionMax = 0.0;
+        double positionSquares = 0.0;
+        double velocityMax = 0.0;
+        double velocitySquares = 0.0;
+        double elementsMax = 0.0;
+    };
+
+    /// Difference of two angles folded into [-pi, pi].
+    auto angleDifference(double a, double b) -> double { return std::remainder(a - b, 2.0*std::numbers::pi); }
+
+    template<typename ScalarType>
+    auto grid() -> ElementGrid<ScalarType>
+    {
+        const auto pi = std::numbers::pi_v<ScalarType>;
+        return ElementGrid<ScalarType>{{GridAxis<ScalarType>{ScalarType(7.0e6), ScalarType(4.2164e7), 2},
+                                        GridAxis<ScalarType>{0, ScalarType(0.95), 20},
+                                        GridAxis<ScalarType>{0, pi, 19},
+                                        GridAxis<ScalarType>{0, 2*pi*ScalarType(23.0/24.0), 24},
+                                        GridAxis<ScalarType>{0, 2*pi*ScalarType(5.0/6.0), 6},
+                                        GridAxis<ScalarType>{0, 2*pi*ScalarType(11.0/12.0), 12}}};
+    }
+
+    /// Best of three single threaded timings of sampleReduce with the given per sample work, in samples per second.
+    template<typename ScalarType, typename Work>
+    auto rate(const ElementGrid<ScalarType> &samples, Work work) -> double
+    {
+        auto best = std::numeric_limits<double>::max();
+        for (auto run = 0; run < 3; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            auto checksum = sampleReduce(samples, 0.0, [&](double &sum, const KeplerianElements<ScalarType> &elements,
+                                                          const StateVector<ScalarType> &state) {
+                sum += work(elements, state);
+            }, [](double &into, double from) { into += from; }, 1);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (!std::isfinite(checksum)) std::cerr << "non-finite checksum\n";
+            best = std::min(best, elapsed.count());
+        }
+        return double(samples.size())/best;
+    }
+
+    template<typename ScalarType>
+    auto measure(const std::string &prefix, Measurements &results) -> void
+    {
+        auto samples = grid<ScalarType>();
+        auto statistics = sampleReduce(samples, ErrorStatistics{}, [](ErrorStatistics &s,
+                                                                      const KeplerianElements<ScalarType> &elements,
+                                                                      const StateVector<ScalarType> &state) {
+            KeplerianElements<ScalarType> recovered{state};
+            StateVector<ScalarType> again{recovered};
+            auto position = double((again.r - state.r).norm()/state.r.norm());
+            auto velocity = double((again.v - state.v).norm()/state.v.norm());
+            ++s.count;
+            s.positionMax = std::max(s.positionMax, position);
+            s.positionSquares += position*position;
+            s.velocityMax = std::max(s.velocityMax, velocity);
+            s.velocitySquares += velocity*velocity;
+
+            // Element by element only away from circular and equatorial orbits, where angles are undefined.
+            if (elements.eccentricity >= 0.05 && std::sin(elements.inclination) >= 0.05) {
+                ++s.elementCount;
+                double difference[] = {
+                        std::abs(recovered.semiMajorAxis/elements.semiMajorAxis - 1),
+                        std::abs(recovered.eccentricity - elements.eccentricity),
+                        std::abs(recovered.inclination - elements.inclination),
+                        std::abs(angleDifference(recovered.rightAscensionAscendingNode,
+                                                 elements.rightAscensionAscendingNode)),
+                        std::abs(angleDifference(recovered.argumentOfPeriapsis, elements.argumentOfPeriapsis)),
+                        std::abs(angleDifference(recovered.trueAnomaly, elements.trueAnomaly))};
+                s.elementsMax = std::max(s.elementsMax, *std::max_element(std::begin(difference),
+                                                                          std::end(difference)));
+            }
+        }, [](ErrorStatistics &into, const ErrorStatistics &from) {
+            into.count += from.count;
+            into.elementCount += from.elementCount;
+            into.positionMax = std::max(into.positionMax, from.positionMax);
+            into.positionSquares += from.positionSquares;
+            into.velocityMax = std::max(into.velocityMax, from.velocityMax);
+            into.velocitySquares += from.velocitySquares;
+            into.elementsMax = std::max(into.elementsMax, from.elementsMax);
+        });
+
+        auto toState = rate(samples, [](const KeplerianElements<ScalarType> &, const StateVector<ScalarType> &state) {
+            return double(state.r[0]);
+        });
+        auto roundTrip = rate(samples, [](const KeplerianElements<ScalarType> &, const StateVector<ScalarType> &state) {
+            return double(KeplerianElements<ScalarType>{state}.trueAnomaly);
+        });
+
+        std::cout << prefix << ": " << statistics.count << " round trips, " << statistics.elementCount
+                  << " element comparisons\n";
+        results.emplace_back(prefix + ".position.max", statistics.positionMax);
+        results.emplace_back(prefix + ".position.rms", std::sqrt(statistics.positionSquares/statistics.count));
+        results.emplace_back(prefix + ".velocity.max", statistics.velocityMax);
+        results.emplace_back(prefix + ".velocity.rms", std::sqrt(statistics.velocitySquares/statistics.count));
+        results.emplace_back(prefix + ".elements.max", statistics.elementsMax);
+        results.emplace_back(prefix + ".toState.rate", toState);
+        // Elements from state alone: the round trip pass less the time the first pass spent making states.
+        results.emplace_back(prefix + ".toElements.rate", 1.0/(1.0/roundTrip - 1.0/toState));
+    }
+
+    auto readBaselines(const std::string &path) -> std::map<std::string, double>
+    {
+        std::map<std::string, double> baselines;
+        std::ifstream in{path};
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream fields{line};
+            std::string name;
+            double value;
+            if (fields >> name >> value) baselines[name] = value;
+        }
+        return baselines;
+    }
+
+    auto writeBaselines(const std::string &path, const Measurements &results) -> bool
+    {
+        std::ofstream out{path};
+        out << "# Baselines for regression-conversion: relative round trip errors (position, velocity), largest\n"
+            << "# element error away from singular orbits (radians, or relative for a), and single thread rates in\n"
+            << "# conversions per second.  Regenerate with: regression-conversion <this file> --update\n";
+        for (const auto &[name, value]: results) out << name << " " << std::setprecision(4) << value << "\n";
+        return bool(out);
+    }
+
+    auto isRate(const std::string &name) -> bool { return name.ends_with(".rate"); }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        std::cerr << "usage: regression-conversion baseline-file [--update] [--check-rates] [--error-factor f] "
+                     "[--time-tolerance t]\n";
+        return 2;
+    }
+    std::string path = argv[1];
+    auto update = false;
+    auto rateCheckRequested = false;
+    auto errorFactor = 4.0;
+    auto timeTolerance = 0.5;
+    for (auto k = 2; k < argc; ++k) {
+        std::string option = argv[k];
+        if (option == "--update") update = true;
+        else if (option == "--check-rates") rateCheckRequested = true;
+        else if (option == "--error-factor" && k + 1 < argc) errorFactor = std::atof(argv[++k]);
+        else if (option == "--time-tolerance" && k + 1 < argc) timeTolerance = std::atof(argv[++k]);
+        else {
+            std::cerr << "unknown option " << option << "\n";
+            return 2;
+        }
+    }
+#ifdef NDEBUG
+    const auto optimized = true;
+#else
+    const auto optimized = false;
+#endif
+    const auto checkRates = rateCheckRequested && optimized;
+
+    Measurements results;
+    measure<double>("double", results);
+    measure<float>("float", results);
+
+    if (update) {
+        if (!writeBaselines(path, results)) {
+            std::cerr << "cannot write " << path << "\n";
+            return 2;
+        }
+        std::cout << "baselines written to " << path << "\n";
+        return 0;
+    }
+
+    auto baselines = readBaselines(path);
+    auto failures = 0;
+    std::cout << std::left << std::setw(24) << "metric" << std::right << std::setw(14) << "measured"
+              << std::setw(14) << "baseline" << std::setw(14) << "limit" << "\n";
+    for (const auto &[name, value]: results) {
+        std::cout << std::left << std::setw(24) << name << std::right << std::setprecision(4) << std::setw(14) << value;
+        auto found = baselines.find(name);
+        if (found == baselines.end()) {
+            std::cout << std::setw(14) << "-" << std::setw(14) << "-" << "  no baseline\n";
+            continue;
+        }
+        auto baseline = found->second;
+        auto limit = isRate(name) ? baseline*(1.0 - timeTolerance) : baseline*errorFactor;
+        auto failed = isRate(name) ? checkRates && value < limit : !(value <= limit);
+        auto note = failed ? "  REGRESSED" : !isRate(name) || checkRates ? ""
+                  : optimized ? "  not checked" : "  not checked, unoptimized";
+        std::cout << std::setw(14) << baseline << std::setw(14) << limit << note << "\n";
+        if (failed) ++failures;
+    }
+    if (baselines.empty()) {
+        std::cerr << "no baselines in " << path << "\n";
+        return 1;
+    }
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,268 @@
+// -*- mode: c++ -*-
+////
+// Test numutil::AsyncExecutor and the orbit asynchronous batch functions
+//
+// Part of the orbit test suite
+//
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_DYN_LINK
+#pragma clang diagnostic pop
+
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <vector>
+#include "async.hpp"
+#include "propagator.hpp"
+
+using namespace orbit;
+using numutil::AsyncExecutor;
+using numutil::BatchStatus;
+
+namespace {
+    /// Coroutine run eagerly and never awaited, the way an event loop handler is started.
+    struct Detached {
+        struct promise_type {
+            auto get_return_object() -> Detached { return {}; }
+            auto initial_suspend() noexcept -> std::suspend_never { return {}; }
+            auto final_suspend() noexcept -> std::suspend_never { return {}; }
+            auto return_void() -> void {}
+            auto unhandled_exception() -> void { std::terminate(); }
+        };
+    };
+
+    auto catalog(std::size_t count) -> std::vector<KeplerianElements<double>>
+    {
+        std::vector<KeplerianElements<double>> elements;
+        for (auto k = 0u; k < count; ++k) {
+            elements.emplace_back(7.0e6 + 1.0e4*k, 0.001*(k % 500), 0.001*k, 0.01*k, 0.02*k, 0.03*k);
+        }
+        return elements;
+    }
+
+    auto awaitStates(AsyncExecutor &executor, std::vector<KeplerianElements<double>> elements,
+                     std::promise<std::vector<StateVector<double>>> &out, std::thread::id &resumedOn) -> Detached
+    {
+        auto states = co_await toStatesAsync(executor, std::move(elements));
+        resumedOn = std::this_thread::get_id();
+        out.set_value(std::move(states));
+    }
+
+    /// Occupy the single worker of an executor until open is set.
+    auto blockWorker(AsyncExecutor &executor, std::atomic<bool> &open)
+    {
+        return executor.map(std::vector<int>(1), [&open](int) {
+            while (!open) std::this_thread::yield();
+            return 0;
+        });
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE(async_suite)
+
+    BOOST_AUTO_TEST_CASE(batch_matches_synchronous_test) {
+        AsyncExecutor executor{3, 1u << 20, 100};
+        auto elements = catalog(2500);
+        auto states = toStatesAsync(executor, elements).get();
+        BOOST_REQUIRE_EQUAL(states.size(), elements.size());
+        for (auto k = 0u; k < elements.size(); ++k) {
+            StateVector<double> expected{elements[k]};
+            BOOST_CHECK_EQUAL((states[k].r - expected.r).norm(), 0.0);
+            BOOST_CHECK_EQUAL((states[k].v - expected.v).norm(), 0.0);
+        }
+
+        auto recovered = toElementsAsync(executor, states).get();
+        BOOST_REQUIRE_EQUAL(recovered.size(), states.size());
+        for (auto k = 0u; k < states.size(); ++k) {
+            BOOST_CHECK_EQUAL(recovered[k].trueAnomaly, KeplerianElements<double>{states[k]}.trueAnomaly);
+        }
+
+        KeplerPropagator<double> propagator;
+        auto later = propagateAsync(executor, propagator, states, 600.0).get();
+        for (auto k = 0u; k < states.size(); k += 97) {
+            BOOST_CHECK_EQUAL((later[k].r - propagator.propagate(states[k], 600.0).r).norm(), 0.0);
+        }
+
+        auto empty = toStatesAsync(executor, std::vector<KeplerianElements<double>>{});
+        BOOST_CHECK(empty.ready());
+        BOOST_CHECK(empty.get().empty());
+        BOOST_CHECK_EQUAL(executor.inFlight(), 0u);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(coroutine_test) {
+        // With the only worker held, the coroutine has to suspend, and resumes on the worker.
+        AsyncExecutor executor{1, 1u << 20, 64};
+        std::atomic<bool> open{false};
+        auto gate = blockWorker(executor, open);
+        auto elements = catalog(1000);
+        std::promise<std::vector<StateVector<double>>> out;
+        auto result = out.get_future();
+        std::thread::id resumedOn;
+        awaitStates(executor, elements, out, resumedOn);
+        BOOST_CHECK(result.wait_for(std::chrono::milliseconds(10)) == std::future_status::timeout);
+        open = true;
+
+        auto states = result.get();
+        BOOST_REQUIRE_EQUAL(states.size(), elements.size());
+        BOOST_CHECK_EQUAL((states[999].r - StateVector<double>{elements[999]}.r).norm(), 0.0);
+        BOOST_CHECK(resumedOn != std::this_thread::get_id());
+    }
+
+
+    BOOST_AUTO_TEST_CASE(cancellation_test) {
+        AsyncExecutor executor{1, 1u << 20, 1};
+        std::atomic<bool> open{false};
+        auto gate = blockWorker(executor, open);
+
+        std::atomic<int> calls{0};
+        auto count = [&calls](const KeplerianElements<double> &e) {
+            ++calls;
+            return StateVector<double>{e};
+        };
+        auto cancelled = executor.map(catalog(10), count);
+        std::stop_source stop;
+        auto stopped = executor.map(catalog(10), count, stop.get_token());
+        auto kept = executor.map(catalog(10), count);
+        std::atomic<bool> notified{false};
+        cancelled.onComplete([&notified] { notified = true; });
+
+        cancelled.cancel();
+        stop.request_stop();
+        BOOST_CHECK(cancelled.status() == BatchStatus::pending);
+        open = true;
+
+        BOOST_CHECK_THROW(cancelled.get(), numutil::OperationCancelled);
+        BOOST_CHECK(stopped.wait() == BatchStatus::cancelled);
+        BOOST_CHECK_THROW(stopped.get(), numutil::OperationCancelled);
+        BOOST_CHECK_EQUAL(kept.get().size(), 10u);
+        BOOST_CHECK_EQUAL(gate.get().size(), 1u);
+        BOOST_CHECK_EQUAL(calls, 10);
+        BOOST_CHECK(notified);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(bounded_in_flight_test) {
+        AsyncExecutor executor{1, 10, 1};
+        std::atomic<bool> open{false};
+        auto gate = blockWorker(executor, open);
+        auto queued = executor.map(std::vector<int>(6), [](int) { return 1; });
+        BOOST_CHECK_EQUAL(executor.inFlight(), 7u);
+
+        BOOST_CHECK(!executor.tryMap(std::vector<int>(4), [](int) { return 1; }));
+        auto fits = executor.tryMap(std::vector<int>(3), [](int) { return 1; });
+        BOOST_REQUIRE(fits);
+        BOOST_CHECK_EQUAL(executor.inFlight(), 10u);
+
+        // An event loop submitting at capacity gets its handle back at once; the batch is parked until room frees.
+        auto submitted = std::async(std::launch::async, [&executor] {
+            return toStatesAsync(executor, catalog(5));
+        });
+        BOOST_REQUIRE(submitted.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        auto parked = submitted.get();
+        BOOST_CHECK_EQUAL(executor.waiting(), 1u);
+        BOOST_CHECK(parked.status() == BatchStatus::pending);
+        BOOST_CHECK_EQUAL(executor.inFlight(), 10u);
+
+        // While a batch is parked, tryMap declines even what would fit, so the parked one is not starved.
+        BOOST_CHECK(!executor.tryMap(std::vector<int>(1), [](int) { return 1; }));
+        open = true;
+        BOOST_CHECK_EQUAL(parked.get().size(), 5u);
+        fits->wait();
+        queued.wait();
+        gate.wait();
+        BOOST_CHECK_EQUAL(executor.waiting(), 0u);
+        BOOST_CHECK_EQUAL(executor.inFlight(), 0u);
+
+        // Larger than the bound on its own, admitted when nothing else is in flight.
+        auto oversized = executor.tryMap(std::vector<int>(50), [](int) { return 3; });
+        BOOST_REQUIRE(oversized);
+        BOOST_CHECK_EQUAL(oversized->get().size(), 50u);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(cancel_parked_test) {
+        // With the executor saturated, cancelling a parked batch finishes it at once, without taking any room.
+        AsyncExecutor executor{1, 4, 1};
+        std::atomic<bool> open{false};
+        auto gate = blockWorker(executor, open);
+        auto filler = executor.map(std::vector<int>(3), [](int) { return 1; });
+        std::atomic<int> calls{0};
+        auto count = [&calls](int) { return ++calls; };
+        auto cancelled = executor.map(std::vector<int>(4), count);
+        std::stop_source stop;
+        auto stopped = executor.map(std::vector<int>(4), count, stop.get_token());
+        auto kept = executor.map(std::vector<int>(4), count);
+        BOOST_CHECK_EQUAL(executor.waiting(), 3u);
+
+        std::atomic<bool> notified{false};
+        cancelled.onComplete([&notified] { notified = true; });
+        cancelled.cancel();
+        BOOST_CHECK(cancelled.status() == BatchStatus::cancelled);
+        BOOST_CHECK(notified);
+        BOOST_CHECK_THROW(cancelled.get(), numutil::OperationCancelled);
+        stop.request_stop();
+        BOOST_CHECK(stopped.ready());
+        BOOST_CHECK_THROW(stopped.get(), numutil::OperationCancelled);
+        BOOST_CHECK_EQUAL(executor.waiting(), 1u);
+        BOOST_CHECK_EQUAL(executor.inFlight(), 4u);
+
+        // A token already stopped withdraws the batch as it is parked.
+        auto late = executor.map(std::vector<int>(4), count, stop.get_token());
+        BOOST_CHECK(late.status() == BatchStatus::cancelled);
+        BOOST_CHECK_EQUAL(executor.waiting(), 1u);
+
+        open = true;
+        BOOST_CHECK_EQUAL(kept.get().size(), 4u);
+        BOOST_CHECK_EQUAL(calls, 4);
+        filler.wait();
+        gate.wait();
+        BOOST_CHECK_EQUAL(executor.inFlight(), 0u);
+        kept.cancel();
+    }
+
+
+    BOOST_AUTO_TEST_CASE(continuation_submits_test) {
+        // A continuation on the only pool thread submits more than there is room for; it must not park the worker.
+        AsyncExecutor executor{1, 4, 1};
+        std::atomic<bool> open{false};
+        auto gate = blockWorker(executor, open);
+        auto first = executor.map(std::vector<int>(3), [](int) { return 1; });
+        std::promise<std::size_t> followed;
+        auto result = followed.get_future();
+        std::optional<numutil::BatchResult<int>> next;
+        first.onComplete([&] {
+            auto filler = executor.map(std::vector<int>(4), [](int) { return 2; });
+            next.emplace(executor.map(std::vector<int>(4), [](int) { return 3; }));
+            next->onComplete([&followed, filler] { followed.set_value(4); });
+        });
+        open = true;
+        BOOST_REQUIRE(result.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        BOOST_CHECK_EQUAL(next->get().size(), 4u);
+        BOOST_CHECK_EQUAL(executor.inFlight(), 0u);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(failure_test) {
+        AsyncExecutor executor{2, 1u << 20, 4};
+        std::vector<int> inputs(40);
+        for (auto k = 0u; k < inputs.size(); ++k) inputs[k] = int(k);
+        auto batch = executor.map(inputs, [](int k) {
+            if (k == 13) throw std::domain_error{"bad item"};
+            return k;
+        });
+        BOOST_CHECK(batch.wait() == BatchStatus::failed);
+        BOOST_CHECK_THROW(batch.get(), std::domain_error);
+        BOOST_CHECK_EQUAL(executor.inFlight(), 0u);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
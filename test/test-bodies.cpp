@@ -0,0 +1,97 @@
+// -*- mode: c++ -*-
+////
+// Test the compile time central bodies of bodies.hpp
+//
+// Part of the orbit test suite
+//
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_DYN_LINK
+#pragma clang diagnostic pop
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <numbers>
+#include "bodies.hpp"
+
+using namespace orbit;
+
+static_assert(numutil::constexprSqrt(4.0) == 2.0);
+static_assert(Earth::mu == muEarth && Earth::radius == earthEquatorialRadius*1.0e3 && Earth::j2 == earthJ2);
+static_assert(Moon::mu == muMoon && Moon::radius == moonRadius && Sun::mu == muSun && Sun::radius == sunRadius);
+static_assert(BodyGravity<Earth, double>::sqrtMu*BodyGravity<Earth, double>::sqrtMu
+              == BodyGravity<Earth, double>::mu);
+static_assert(sizeof(BodyElements<Earth, double>) == 6*sizeof(double));
+static_assert(sizeof(BodyKeplerPropagator<Earth, double>) < sizeof(KeplerPropagator<double>));
+
+namespace {
+    template<typename Body>
+    auto checkBody(double a) -> void
+    {
+        BodyElements<Body, double> elements{a, 0.3, 1.1, 2.0, 0.7, 0.4};
+        auto state = toState(elements);
+        StateVector<double> runtime{elements.toKeplerian()};
+        BOOST_CHECK_SMALL((state.r - runtime.r).norm()/a, 1.0e-14);
+        BOOST_CHECK_SMALL((state.v - runtime.v).norm()/runtime.v.norm(), 1.0e-14);
+
+        auto recovered = toElements<Body>(state);
+        BOOST_CHECK_CLOSE(recovered.semiMajorAxis, a, 1.0e-10);
+        BOOST_CHECK_SMALL(recovered.eccentricity - 0.3, 1.0e-13);
+        BOOST_CHECK_SMALL(recovered.inclination - 1.1, 1.0e-13);
+        BOOST_CHECK_SMALL(recovered.rightAscensionAscendingNode - 2.0, 1.0e-13);
+        BOOST_CHECK_SMALL(recovered.argumentOfPeriapsis - 0.7, 1.0e-12);
+        BOOST_CHECK_SMALL(recovered.trueAnomaly - 0.4, 1.0e-12);
+
+        // One period later the orbit closes, and agrees with the runtime mu propagator along the way.
+        auto period = 2.0*std::numbers::pi*std::sqrt(a*a*a/Body::mu);
+        BodyKeplerPropagator<Body, double> propagator;
+        KeplerPropagator<double> runtimePropagator{Body::mu};
+        BOOST_CHECK_EQUAL(propagator.gravitationalConstant(), runtimePropagator.gravitationalConstant());
+        auto closed = propagator.propagate(state, period);
+        BOOST_CHECK_SMALL((closed.r - state.r).norm()/a, 1.0e-10);
+        auto partway = propagator.propagate(state, period/3);
+        BOOST_CHECK_SMALL((partway.r - runtimePropagator.propagate(state, period/3).r).norm()/a, 1.0e-13);
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE(bodies_suite)
+
+    BOOST_AUTO_TEST_CASE(bodies_test) {
+        checkBody<Earth>(7.0e6);
+        checkBody<Moon>(2.0e6);
+        checkBody<Mars>(9.4e6);
+        checkBody<Sun>(astronomicalUnit);
+        BOOST_CHECK_EQUAL(Earth::mu, muEarth);
+        BOOST_CHECK_EQUAL(Moon::mu, muMoon);
+        BOOST_CHECK_EQUAL(Sun::mu, muSun);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(single_precision_test) {
+        BodyElements<Mars, float> elements{9.4e6f, 0.01f, 0.5f, 1.0f, 2.0f, 3.0f};
+        auto recovered = toElements<Mars>(toState(elements));
+        BOOST_CHECK_CLOSE(recovered.semiMajorAxis, elements.semiMajorAxis, 1.0e-3);
+        BOOST_CHECK_SMALL(recovered.trueAnomaly - elements.trueAnomaly, 1.0e-3f);
+        auto state = BodyKeplerPropagator<Mars, float>{}.propagate(toState(elements), 600.0f);
+        auto expected = KeplerPropagator<float>{float(Mars::mu)}.propagate(toState(elements), 600.0f);
+        BOOST_CHECK_SMALL((state.r - expected.r).norm()/elements.semiMajorAxis, 1.0e-5f);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(harmonic_propagators_test) {
+        // Mars J2 regresses the node of a low prograde orbit.
+        BodyElements<Mars, double> elements{3.8e6, 0.001, 0.5, 1.0, 0.0, 0.0};
+        auto secular = secularJ2PropagatorFor(elements);
+        auto sol = 88775.0;
+        auto meanNode = toElements<Mars>(secular.propagate(sol)).rightAscensionAscendingNode;
+        BOOST_CHECK_LT(meanNode, 1.0);
+
+        auto cowell = j2PropagatorFor<Mars, double>(10.0);
+        BOOST_CHECK_EQUAL(cowell.gravitationalConstant(), Mars::mu);
+        auto state = cowell.propagate(toState(elements), sol);
+        auto node = toElements<Mars>(state).rightAscensionAscendingNode;
+        BOOST_CHECK_CLOSE(node - 1.0, meanNode - 1.0, 5.0);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
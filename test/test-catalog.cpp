@@ -0,0 +1,127 @@
+// -*- mode: c++ -*-
+////
+// Test orbit::IncrementalCatalog
+//
+// Part of the orbit test suite
+//
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_DYN_LINK
+#pragma clang diagnostic pop
+
+#include <boost/test/unit_test.hpp>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include "catalog.hpp"
+
+using namespace orbit;
+
+namespace {
+    auto elements(std::size_t k, double shift = 0.0) -> KeplerianElements<double>
+    {
+        return {7.0e6 + 1.0e4*double(k) + shift, 0.001*double(k % 50), 0.01*double(k), 0.02*double(k), 0.5, 0.1*double(k)};
+    }
+
+    auto matches(const IncrementalCatalog<double> &catalog, const std::vector<StateVector<double>> &states, double t)
+            -> bool
+    {
+        for (std::size_t k = 0; k < catalog.size(); ++k) {
+            auto expected = catalog.model(k).propagate(t);
+            if ((states[k].r - expected.r).norm() != 0.0 || (states[k].v - expected.v).norm() != 0.0) return false;
+        }
+        return true;
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE(catalog_suite)
+
+    BOOST_AUTO_TEST_CASE(recompute_dirty_test) {
+        IncrementalCatalog<double> catalog{4, 3};
+        for (std::size_t k = 0; k < 200; ++k) catalog.add(elements(k), 0.0);
+        BOOST_CHECK_EQUAL(catalog.dirtyCount(600.0), 200u);
+
+        BOOST_CHECK(matches(catalog, catalog.states(600.0), 600.0));
+        BOOST_CHECK_EQUAL(catalog.statistics().misses, 200u);
+        BOOST_CHECK_EQUAL(catalog.statistics().hits, 0u);
+        BOOST_CHECK_EQUAL(catalog.dirtyCount(600.0), 0u);
+
+        // Nothing changed: all hits.
+        catalog.states(600.0);
+        BOOST_CHECK_EQUAL(catalog.statistics().misses, 200u);
+        BOOST_CHECK_EQUAL(catalog.statistics().hits, 200u);
+
+        // Five objects change, one of them twice, and one is added.
+        for (auto id: {3u, 17u, 17u, 50u, 51u, 199u}) catalog.update(id, elements(id, 500.0), 60.0);
+        catalog.add(elements(200), 0.0);
+        BOOST_CHECK_EQUAL(catalog.dirtyCount(600.0), 6u);
+        const auto &states = catalog.states(600.0);
+        BOOST_CHECK_EQUAL(states.size(), 201u);
+        BOOST_CHECK(matches(catalog, states, 600.0));
+        BOOST_CHECK_EQUAL(catalog.statistics().misses, 206u);
+        BOOST_CHECK_EQUAL(catalog.statistics().hits, 395u);
+        BOOST_CHECK_EQUAL(catalog.statistics().evaluations, 3u);
+        BOOST_CHECK_EQUAL(catalog.statistics().fullScans, 0u);
+        BOOST_CHECK_CLOSE(catalog.statistics().hitRate(), 395.0/601.0, 1.0e-9);
+
+        BOOST_CHECK_THROW(catalog.update(500, elements(0), 0.0), std::out_of_range);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(epochs_test) {
+        IncrementalCatalog<double> catalog{2, 2};
+        for (std::size_t k = 0; k < 50; ++k) catalog.add(elements(k), 0.0);
+        catalog.states(0.0);
+        catalog.states(3600.0);
+        catalog.update(7, elements(7, 100.0), 0.0);
+
+        // Both epochs see the change; each recomputes only it.
+        catalog.resetStatistics();
+        BOOST_CHECK(matches(catalog, catalog.states(0.0), 0.0));
+        BOOST_CHECK(matches(catalog, catalog.states(3600.0), 3600.0));
+        BOOST_CHECK_EQUAL(catalog.statistics().misses, 2u);
+
+        // A third epoch evicts the least recently used, 0.
+        catalog.states(7200.0);
+        BOOST_CHECK_EQUAL(catalog.statistics().epochsCreated, 1u);
+        BOOST_CHECK_EQUAL(catalog.statistics().epochsEvicted, 1u);
+        BOOST_CHECK_EQUAL(catalog.dirtyCount(0.0), 50u);
+        BOOST_CHECK_EQUAL(catalog.dirtyCount(3600.0), 0u);
+
+        // Single lookups hit a current cache and refresh a stale entry in place.
+        catalog.resetStatistics();
+        auto state = catalog.state(9, 3600.0);
+        BOOST_CHECK_EQUAL((state.r - catalog.model(9).propagate(3600.0).r).norm(), 0.0);
+        catalog.update(9, elements(9, 10.0), 0.0);
+        catalog.state(9, 3600.0);
+        catalog.state(9, 3600.0);
+        catalog.state(9, 100.0);
+        BOOST_CHECK_EQUAL(catalog.statistics().hits, 2u);
+        BOOST_CHECK_EQUAL(catalog.statistics().misses, 2u);
+        BOOST_CHECK_EQUAL(catalog.dirtyCount(3600.0), 0u);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(log_overflow_test) {
+        // More changes than objects between evaluations drop the log; the cache then compares versions.
+        IncrementalCatalog<double> catalog{4, 1};
+        for (std::size_t k = 0; k < 20; ++k) catalog.add(elements(k), 0.0);
+        catalog.states(60.0);
+        for (auto round = 0; round < 3; ++round) {
+            for (std::size_t k = 0; k < 10; ++k) catalog.update(k, elements(k, 1.0 + round), 0.0);
+        }
+        catalog.resetStatistics();
+        BOOST_CHECK_EQUAL(catalog.dirtyCount(60.0), 10u);
+        BOOST_CHECK(matches(catalog, catalog.states(60.0), 60.0));
+        BOOST_CHECK_EQUAL(catalog.statistics().fullScans, 1u);
+        BOOST_CHECK_EQUAL(catalog.statistics().misses, 10u);
+
+        catalog.update(15, elements(15, 2.0), 0.0);
+        catalog.resetStatistics();
+        BOOST_CHECK(matches(catalog, catalog.states(60.0), 60.0));
+        BOOST_CHECK_EQUAL(catalog.statistics().fullScans, 0u);
+        BOOST_CHECK_EQUAL(catalog.statistics().misses, 1u);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
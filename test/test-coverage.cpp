@@ -0,0 +1,210 @@
+// -*- mode: c++ -*-
+////
+// Test ground tracks and orbit::CoverageGrid
+//
+// Part of the orbit test suite
+//
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_DYN_LINK
+#pragma clang diagnostic pop
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+#include <vector>
+#include "coverage.hpp"
+
+using namespace orbit;
+using vector3 = numutil::Vector3<double>;
+
+namespace {
+    const auto pi = std::numbers::pi;
+    const auto degree = pi/180.0;
+
+    auto sameCells(const CoverageGrid &a, const CoverageGrid &b) -> bool
+    {
+        for (std::size_t row = 0; row < a.rows(); ++row) {
+            for (std::size_t column = 0; column < a.columns(); ++column) {
+                const auto &x = a.cell(row, column);
+                const auto &y = b.cell(row, column);
+                if (x.first != y.first || x.last != y.last || x.lastStart != y.lastStart || x.covered != y.covered
+                    || x.gaps != y.gaps || x.gapSum != y.gapSum || x.gapMax != y.gapMax) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE(coverage_suite)
+
+    BOOST_AUTO_TEST_CASE(sub_satellite_point_test) {
+        BOOST_CHECK_CLOSE(earthRotationAngle(0.0), 2*pi*0.7790572732640, 1.0e-12);
+        BOOST_CHECK_SMALL(std::remainder(earthRotationAngle(1.0e8 + 86164.0989) - earthRotationAngle(1.0e8), 2*pi),
+                          1.0e-6);
+
+        // On the equator under the Greenwich meridian whatever the time.
+        auto t = 1234.5;
+        auto theta = earthRotationAngle(t);
+        auto point = subSatellitePoint(vector3{7.0e6*std::cos(theta), 7.0e6*std::sin(theta), 0.0}, t);
+        BOOST_CHECK_SMALL(point.latitude, 1.0e-12);
+        BOOST_CHECK_SMALL(point.longitude, 1.0e-12);
+        BOOST_CHECK_CLOSE(point.altitude, 7.0e6 - 6378137.0, 1.0e-9);
+
+        // A point 500 km above geodetic 40 degrees north, 30 west.
+        const auto a = 6378137.0;
+        const auto e2 = earthFlattening*(2.0 - earthFlattening);
+        auto latitude = 40*degree, longitude = -30*degree, height = 5.0e5;
+        auto n = a/std::sqrt(1 - e2*std::sin(latitude)*std::sin(latitude));
+        vector3 fixed{(n + height)*std::cos(latitude)*std::cos(longitude),
+                      (n + height)*std::cos(latitude)*std::sin(longitude), (n*(1 - e2) + height)*std::sin(latitude)};
+        t = 5.0e6;
+        theta = earthRotationAngle(t);
+        vector3 inertial{std::cos(theta)*fixed[0] - std::sin(theta)*fixed[1],
+                         std::sin(theta)*fixed[0] + std::cos(theta)*fixed[1], fixed[2]};
+        point = subSatellitePoint(inertial, t);
+        BOOST_CHECK_SMALL(point.latitude - latitude, 1.0e-9);
+        BOOST_CHECK_SMALL(point.longitude - longitude, 1.0e-12);
+        BOOST_CHECK_SMALL(point.altitude - height, 1.0e-2);
+
+        point = subSatellitePoint(vector3{0.0, 0.0, 7.0e6}, 0.0);
+        BOOST_CHECK_CLOSE(point.latitude, pi/2, 1.0e-12);
+        BOOST_CHECK_CLOSE(point.altitude, 7.0e6 - a*(1 - earthFlattening), 1.0e-9);
+
+        // A polar orbit's track reaches its inclination in latitude.
+        SecularJ2Propagator<double> polar{KeplerianElements<double>{7.0e6, 0.0, 1.5, 0.0, 0.0, 0.0}};
+        auto track = groundTrack(polar, 0.0, polar.period(), 10.0);
+        BOOST_CHECK_EQUAL(track.size(), std::size_t(polar.period()/10.0) + 1);
+        auto highest = 0.0;
+        for (const auto &p: track) highest = std::max(highest, p.latitude);
+        BOOST_CHECK_CLOSE(highest, 1.5, 0.5);
+        BOOST_CHECK_THROW(groundTrack(polar, 0.0, 10.0, 0.0), std::invalid_argument);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(footprint_test) {
+        const auto radius = 6378137.0;
+        Sensor horizon{};
+        BOOST_CHECK_CLOSE(horizon.footprintAngle(7.0e6), std::acos(radius/7.0e6), 1.0e-10);
+
+        // 10 degrees elevation, then a narrow cone that binds first.
+        Sensor elevation{pi/2, 10*degree};
+        auto nadir = std::asin(radius/7.0e6*std::cos(10*degree));
+        BOOST_CHECK_CLOSE(elevation.footprintAngle(7.0e6), pi/2 - nadir - 10*degree, 1.0e-10);
+        Sensor narrow{1*degree, 10*degree};
+        BOOST_CHECK_CLOSE(narrow.footprintAngle(radius + 5.0e5), 5.0e5*std::tan(1*degree)/radius, 0.5);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(rasterize_test) {
+        // Caps over the antimeridian, over a pole and small ones, against a test of every cell center.
+        const double caps[][3] = {{10, 175, 12}, {80, 20, 15}, {-85, -100, 20}, {0, 0, 0.4}, {-30, -179.9, 3},
+                                  {45, 60, 100}};
+        for (auto tile: {1ul, 7ul, 32ul}) {
+            CoverageGrid grid{2.0, tile};
+            BOOST_REQUIRE_EQUAL(grid.rows(), 90u);
+            BOOST_REQUIRE_EQUAL(grid.columns(), 180u);
+            for (auto k = 0; k < 6; ++k) grid.add(caps[k][0]*degree, caps[k][1]*degree, caps[k][2]*degree, 3*k);
+            for (std::size_t row = 0; row < grid.rows(); ++row) {
+                for (std::size_t column = 0; column < grid.columns(); ++column) {
+                    auto latitude = (-90 + 2.0*double(row) + 1)*degree;
+                    auto longitude = (-180 + 2.0*double(column) + 1)*degree;
+                    std::uint32_t expected = 0;
+                    for (const auto &cap: caps) {
+                        auto cosine = std::sin(latitude)*std::sin(cap[0]*degree)
+                                      + std::cos(latitude)*std::cos(cap[0]*degree)*std::cos(longitude - cap[1]*degree);
+                        if (cosine >= std::cos(cap[2]*degree) + 1.0e-12) ++expected;
+                        else if (cosine > std::cos(cap[2]*degree) - 1.0e-12) expected = grid.cell(row, column).covered;
+                    }
+                    BOOST_CHECK_EQUAL(grid.cell(row, column).covered, expected);
+                }
+            }
+        }
+        BOOST_CHECK_THROW(CoverageGrid{0.7}, std::invalid_argument);
+        BOOST_CHECK_THROW(CoverageGrid{-1.0}, std::invalid_argument);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(history_merge_test) {
+        // Covered at steps 0 1, 5 6 7 and 12: three accesses, gaps of 3 and 4 steps.
+        const std::int32_t steps[] = {0, 1, 1, 5, 6, 7, 12};
+        CoverageGrid whole{10.0}, before{10.0}, after{10.0};
+        for (auto step: steps) {
+            whole.add(5*degree, 5*degree, 0.01, step);
+            (step < 6 ? before : after).add(5*degree, 5*degree, 0.01, step);
+        }
+        const auto &cell = whole.cell(9, 18);
+        BOOST_CHECK_EQUAL(cell.first, 0);
+        BOOST_CHECK_EQUAL(cell.last, 12);
+        BOOST_CHECK_EQUAL(cell.lastStart, 12);
+        BOOST_CHECK_EQUAL(cell.covered, 6u);
+        BOOST_CHECK_EQUAL(cell.accesses(), 3u);
+        BOOST_CHECK_EQUAL(cell.gapSum, 7u);
+        BOOST_CHECK_EQUAL(cell.gapMax, 4u);
+        BOOST_CHECK_EQUAL(whole.cell(9, 17).accesses(), 0u);
+
+        before.merge(after);
+        BOOST_CHECK(sameCells(before, whole));
+        BOOST_CHECK_THROW(before.merge(CoverageGrid{5.0}), std::invalid_argument);
+
+        auto statistics = whole.statistics(13, 60.0);
+        auto area = std::sin(10*degree)/2/36;
+        BOOST_CHECK_CLOSE(statistics.coverage, area, 1.0e-9);
+        BOOST_CHECK_CLOSE(statistics.timeCoverage, area*6/13, 1.0e-9);
+        BOOST_CHECK_CLOSE(statistics.revisited, area, 1.0e-9);
+        BOOST_CHECK_CLOSE(statistics.meanRevisit, 6*60.0, 1.0e-9);
+        BOOST_CHECK_CLOSE(statistics.meanGap, 3.5*60.0, 1.0e-9);
+        BOOST_CHECK_CLOSE(statistics.maxGap, 4*60.0, 1.0e-9);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(constellation_test) {
+        std::vector<SecularJ2Propagator<double>> constellation;
+        for (auto plane = 0; plane < 4; ++plane) {
+            for (auto slot = 0; slot < 5; ++slot) {
+                constellation.emplace_back(KeplerianElements<double>{6.9e6, 0.001, 53*degree, plane*pi/2, 0.0,
+                                                                     slot*2*pi/5 + plane*0.3});
+            }
+        }
+        Sensor sensor{40*degree, 10*degree};
+        auto one = computeCoverage<double>(constellation, sensor, 0.0, 21600.0, 60.0, 1.0, 1);
+        auto three = computeCoverage<double>(constellation, sensor, 0.0, 21600.0, 60.0, 1.0, 3, 16);
+        BOOST_CHECK_EQUAL(one.steps, 361);
+        BOOST_CHECK(sameCells(one.grid, three.grid));
+        BOOST_CHECK_EQUAL(one.blocks, 1u);
+        BOOST_CHECK_EQUAL(three.blocks, 3u);
+
+        // A budget for two grids caps the blocks, and one too small for any still runs one, with the same result.
+        auto bytes = CoverageGrid::storageBytes(1.0, 16);
+        BOOST_CHECK_EQUAL(bytes, 192u*368u*sizeof(CoverageCell));
+        auto capped = computeCoverage<double>(constellation, sensor, 0.0, 21600.0, 60.0, 1.0, 3, 16, 2*bytes + 1);
+        auto starved = computeCoverage<double>(constellation, sensor, 0.0, 21600.0, 60.0, 1.0, 3, 16, 1);
+        BOOST_CHECK_EQUAL(capped.blocks, 2u);
+        BOOST_CHECK_EQUAL(starved.blocks, 1u);
+        BOOST_CHECK(sameCells(capped.grid, one.grid));
+        BOOST_CHECK(sameCells(starved.grid, one.grid));
+        BOOST_CHECK_EQUAL(one.statistics.meanGap, three.statistics.meanGap);
+
+        // Nothing above 53 degrees plus the footprint, some of the rest seen more than once.
+        auto reach = 53 + sensor.footprintAngle(6.9e6)/degree;
+        for (std::size_t column = 0; column < 360; ++column) {
+            BOOST_CHECK_EQUAL(one.grid.cell(std::size_t(90 + reach) + 1, column).accesses(), 0u);
+        }
+        BOOST_CHECK_GT(one.statistics.coverage, 0.3);
+        BOOST_CHECK_LT(one.statistics.coverage, std::sin(reach*degree)/2 + 0.5);
+        BOOST_CHECK_GT(one.statistics.revisited, 0.1);
+        BOOST_CHECK_GT(one.statistics.meanRevisit, one.statistics.meanGap);
+        BOOST_CHECK_LE(one.statistics.maxGap, 21600.0);
+
+        std::vector<SecularJ2Propagator<float>> single;
+        single.emplace_back(KeplerianElements<float>{6.9e6f, 0.001f, 0.9f, 0.0f, 0.0f, 0.0f});
+        auto coarse = computeCoverage<float>(single, sensor, 0.0, 6000.0, 30.0, 5.0);
+        BOOST_CHECK_GT(coarse.statistics.coverage, 0.0);
+        BOOST_CHECK_THROW(computeCoverage<float>(single, sensor, 10.0, 0.0, 30.0, 5.0), std::invalid_argument);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+// -*- mode: c++ -*-
+////
+// Test orbit determination
+//
+// Part of the orbit test suite
+//
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_DYN_LINK
+#pragma clang diagnostic pop
+
+#include <boost/test/unit_test.hpp>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include "constants.hpp"
+#include "determination.hpp"
+#include "orbit.hpp"
+#include "propagator.hpp"
+
+using vector3 = numutil::Vector3<double>;
+using namespace orbit;
+
+namespace {
+    const StateVector<double> truth{{1.2915326E+06, 8.4505435E+06, -2.033574E+06}, {-3289.3377, 2493.4338, -7662.0529}};
+
+    auto track(const StateVector<double> &state, double start, double step, int count, double noise,
+               unsigned seed = 1) -> std::vector<PositionObservation<double>>
+    {
+        KeplerPropagator<double> propagator;
+        std::mt19937 generator{seed};
+        std::normal_distribution<double> gaussian{0.0, noise};
+        std::vector<PositionObservation<double>> observations;
+        for (auto k = 0; k < count; ++k) {
+            auto t = start + k*step;
+            auto position = propagator.propagate(state, t).r;
+            for (auto i = 0; i < 3; ++i) position[i] += noise > 0.0 ? gaussian(generator) : 0.0;
+            observations.push_back({t, position, noise > 0.0 ? noise : 1.0});
+        }
+        return observations;
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE(determination_suite)
+
+    BOOST_AUTO_TEST_CASE(gibbs_test) {
+        auto observations = track(truth, -1200.0, 1200.0, 3, 0.0);
+        auto state = gibbs(observations[0].position, observations[1].position, observations[2].position);
+        BOOST_CHECK_SMALL((state.r - truth.r).norm(), 1.0e-6);
+        BOOST_CHECK_SMALL((state.v - truth.v).norm()/truth.v.norm(), 1.0e-9);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(herrick_gibbs_test) {
+        auto observations = track(truth, -30.0, 30.0, 3, 0.0);
+        auto state = initialOrbit(observations[0], observations[1], observations[2]);
+        // Herrick-Gibbs truncation error is fifth order in the spacing.
+        BOOST_CHECK_SMALL((state.v - truth.v).norm()/truth.v.norm(), 1.0e-7);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(batch_least_squares_test) {
+        auto observations = track(truth, -600.0, 20.0, 61, 10.0);
+        BatchLeastSquares<double> solver;
+        auto result = solver.fit(observations);
+
+        BOOST_CHECK(result.converged);
+        BOOST_CHECK_EQUAL(result.epoch, 0.0);
+        BOOST_CHECK_SMALL((result.state.r - truth.r).norm(), 10.0);
+        BOOST_CHECK_SMALL((result.state.v - truth.v).norm(), 0.1);
+        // Residuals are weighted by 1/sigma, so a good fit leaves unit RMS.
+        BOOST_CHECK_CLOSE(result.rms, 1.0, 25.0);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(degenerate_track_test) {
+        BatchLeastSquares<double> solver;
+        auto observations = track(truth, 0.0, 60.0, 2, 0.0);
+        BOOST_CHECK(!solver.fit(observations).converged);
+        BOOST_CHECK(!solver.fit(truth, 0.0, std::span(observations).first(1)).converged);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(determine_orbits_test) {
+        KeplerPropagator<double> propagator;
+        std::vector<StateVector<double>> states;
+        std::vector<std::vector<PositionObservation<double>>> observations;
+        for (auto k = 0; k < 16; ++k) {
+            states.push_back(propagator.propagate(truth, 500.0*k));
+            observations.push_back(track(states.back(), -300.0, 30.0, 21, 1.0, k + 1));
+        }
+        std::vector<std::span<const PositionObservation<double>>> tracks{observations.begin(), observations.end()};
+        std::vector<FitResult<double>> results(tracks.size());
+
+        determineOrbits<double>(tracks, results, muEarth, 4);
+        for (auto k = 0u; k < results.size(); ++k) {
+            BOOST_CHECK(results[k].converged);
+            BOOST_CHECK_SMALL((results[k].state.r - states[k].r).norm(), 5.0);
+        }
+
+        std::span<FitResult<double>> tooShort{results.data(), results.size() - 1};
+        BOOST_CHECK_THROW(determineOrbits<double>(tracks, tooShort, muEarth, 4), std::invalid_argument);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
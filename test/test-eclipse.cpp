@@ -0,0 +1,172 @@
+// -*- mode: c++ -*-
+////
+// Test orbit::EclipseFinder
+//
+// Part of the orbit test suite
+//
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_DYN_LINK
+#pragma clang diagnostic pop
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <vector>
+#include "eclipse.hpp"
+
+using namespace orbit;
+using namespace std::numbers;
+
+namespace {
+    const auto day = 86400.0;
+    const auto equinox = 9575.1*day;    // March 2026
+    const auto solstice = equinox + 93.0*day;
+
+    auto geostationary(double longitude = 0.0) -> SecularJ2Propagator<double>
+    {
+        return SecularJ2Propagator<double>{KeplerianElements<double>{42164.0e3, 0.0, 0.0, 0.0, 0.0, longitude},
+                                           equinox};
+    }
+
+    /// 0 sunlit, 1 penumbra, 2 umbra.
+    auto shadowState(const SecularJ2Propagator<double> &orbit, const EphemerisCache<double> &ephemeris, double t)
+    {
+        auto nu = shadowFunction(orbit.position(t), ephemeris.sun(t));
+        return nu == 1.0 ? 0 : nu == 0.0 ? 2 : 1;
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE(eclipse_suite)
+
+    BOOST_AUTO_TEST_CASE(geostationary_equinox_test) {
+        EphemerisCache<double> ephemeris{equinox - day, equinox + 4.0*day};
+        EclipseFinder<double> finder{ephemeris};
+        auto orbit = geostationary();
+        std::vector<ShadowEvent> events;
+        finder.find(orbit, equinox, equinox + 3.0*day, events);
+
+        BOOST_REQUIRE_EQUAL(events.size(), 12u);
+        for (auto k = 0u; k < events.size(); k += 4) {
+            BOOST_CHECK(events[k].type == ShadowEventType::penumbraEntry);
+            BOOST_CHECK(events[k + 1].type == ShadowEventType::umbraEntry);
+            BOOST_CHECK(events[k + 2].type == ShadowEventType::umbraExit);
+            BOOST_CHECK(events[k + 3].type == ShadowEventType::penumbraExit);
+            auto umbra = events[k + 2].time - events[k + 1].time;
+            BOOST_CHECK_GT(umbra, 60.0*60.0);
+            BOOST_CHECK_LT(umbra, 72.0*60.0);
+            BOOST_CHECK_GT(events[k + 1].time - events[k].time, 60.0);
+            BOOST_CHECK_LT(events[k + 1].time - events[k].time, 300.0);
+        }
+
+        // Each event sits on its boundary to within the tolerance.
+        for (const auto &event: events) {
+            auto before = shadowState(orbit, ephemeris, event.time - 0.01);
+            auto after = shadowState(orbit, ephemeris, event.time + 0.01);
+            switch (event.type) {
+                case ShadowEventType::penumbraEntry: BOOST_CHECK(before == 0 && after == 1); break;
+                case ShadowEventType::umbraEntry: BOOST_CHECK(before == 1 && after == 2); break;
+                case ShadowEventType::umbraExit: BOOST_CHECK(before == 2 && after == 1); break;
+                case ShadowEventType::penumbraExit: BOOST_CHECK(before == 1 && after == 0); break;
+            }
+        }
+
+        // Starting in the middle of an eclipse reports only the way out.
+        std::vector<ShadowEvent> partial;
+        auto middle = (events[1].time + events[2].time)/2;
+        finder.find(orbit, middle, middle + day/2, partial);
+        BOOST_REQUIRE_EQUAL(partial.size(), 2u);
+        BOOST_CHECK(partial[0].type == ShadowEventType::umbraExit);
+        BOOST_CHECK_SMALL(partial[0].time - events[2].time, 1.0e-2);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(geostationary_solstice_test) {
+        EphemerisCache<double> ephemeris{solstice, solstice + 2.0*day};
+        EclipseFinder<double> finder{ephemeris};
+        std::vector<ShadowEvent> events;
+        finder.find(geostationary(), solstice, solstice + 2.0*day, events);
+        BOOST_CHECK(events.empty());
+    }
+
+
+    BOOST_AUTO_TEST_CASE(dense_sampling_test) {
+        // Every change of state seen at one second sampling is found, within a second.
+        EphemerisCache<double> ephemeris{equinox, equinox + day};
+        EclipseFinder<double> finder{ephemeris};
+        for (const auto &elements: {KeplerianElements<double>{6778.0e3, 0.001, 51.6*pi/180.0, 1.0, 0.3, 2.0},
+                                    KeplerianElements<double>{26600.0e3, 0.74, 63.4*pi/180.0, 3.5, 4.7, 0.1}}) {
+            SecularJ2Propagator<double> orbit{elements, equinox};
+            std::vector<ShadowEvent> events;
+            finder.find(orbit, equinox, equinox + day, events);
+
+            std::vector<ShadowEvent> sampled;
+            auto previous = shadowState(orbit, ephemeris, equinox);
+            for (auto t = equinox + 1.0; t <= equinox + day; t += 1.0) {
+                auto state = shadowState(orbit, ephemeris, t);
+                if (state != previous) {
+                    auto type = state > previous ? (state == 1 ? ShadowEventType::penumbraEntry
+                                                               : ShadowEventType::umbraEntry)
+                                                 : (state == 1 ? ShadowEventType::umbraExit
+                                                               : ShadowEventType::penumbraExit);
+                    sampled.push_back({t, 0, type});
+                }
+                previous = state;
+            }
+
+            BOOST_CHECK(!sampled.empty());
+            BOOST_REQUIRE_EQUAL(events.size(), sampled.size());
+            for (auto k = 0u; k < events.size(); ++k) {
+                BOOST_CHECK(events[k].type == sampled[k].type);
+                BOOST_CHECK_GE(events[k].time, sampled[k].time - 1.0);
+                BOOST_CHECK_LE(events[k].time, sampled[k].time);
+            }
+        }
+    }
+
+
+    BOOST_AUTO_TEST_CASE(catalog_test) {
+        EphemerisCache<double> ephemeris{equinox, equinox + 2.0*day};
+        EphemerisCache<float> ephemerisFloat{equinox, equinox + 2.0*day};
+        EclipseFinder<double> finder{ephemeris};
+        EclipseFinder<float> finderFloat{ephemerisFloat};
+        std::vector<SecularJ2Propagator<double>> catalog;
+        std::vector<SecularJ2Propagator<float>> catalogFloat;
+        for (auto k = 0; k < 40; ++k) {
+            auto a = 6.8e6 + 1.0e6*k;
+            auto e = 0.01*(k % 7);
+            auto i = 0.1*k;
+            catalog.emplace_back(KeplerianElements<double>{a, e, i, 0.3*k, 0.2*k, 0.7*k}, equinox);
+            catalogFloat.emplace_back(KeplerianElements<float>{float(a), float(e), float(i), 0.3f*k, 0.2f*k, 0.7f*k},
+                                      equinox);
+        }
+
+        auto lists = findEclipses<double>(finder, catalog, equinox, equinox + 2.0*day, 4);
+        auto floatLists = findEclipses<float>(finderFloat, catalogFloat, equinox, equinox + 2.0*day, 3);
+        BOOST_REQUIRE_EQUAL(lists.size(), catalog.size());
+        for (auto k = 0u; k < catalog.size(); ++k) {
+            std::vector<ShadowEvent> serial;
+            finder.find(catalog[k], equinox, equinox + 2.0*day, serial, k);
+            BOOST_REQUIRE_EQUAL(lists[k].size(), serial.size());
+            for (auto j = 0u; j < serial.size(); ++j) {
+                BOOST_CHECK_EQUAL(lists[k][j].time, serial[j].time);
+                BOOST_CHECK_EQUAL(lists[k][j].object, k);
+            }
+            BOOST_CHECK(std::is_sorted(lists[k].begin(), lists[k].end()));
+
+            // Single precision finds the same events to within a fraction of a second.
+            BOOST_REQUIRE_EQUAL(floatLists[k].size(), serial.size());
+            for (auto j = 0u; j < serial.size(); ++j) BOOST_CHECK_SMALL(floatLists[k][j].time - serial[j].time, 0.5);
+        }
+
+        auto merged = mergeEvents(lists);
+        std::size_t total = 0;
+        for (const auto &list: lists) total += list.size();
+        BOOST_CHECK_EQUAL(merged.size(), total);
+        BOOST_CHECK_GT(total, 100u);
+        BOOST_CHECK(std::is_sorted(merged.begin(), merged.end()));
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
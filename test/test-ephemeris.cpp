@@ -0,0 +1,74 @@
+// -*- mode: c++ -*-
+////
+// Test the analytic Sun and Moon positions and orbit::EphemerisCache
+//
+// Part of the orbit test suite
+//
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_DYN_LINK
+#pragma clang diagnostic pop
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+#include "constants.hpp"
+#include "ephemeris.hpp"
+
+using namespace orbit;
+
+
+BOOST_AUTO_TEST_SUITE(ephemeris_suite)
+
+    BOOST_AUTO_TEST_CASE(sun_test) {
+        // At J2000 the Earth is just past perihelion and the Sun sits near the winter solstice.
+        auto sun = sunPosition<double>(0.0);
+        BOOST_CHECK_CLOSE(sun.norm(), 0.98333*astronomicalUnit, 0.05);
+        auto declination = std::asin(sun[2]/sun.norm())*180.0/std::numbers::pi;
+        BOOST_CHECK_CLOSE(declination, -23.03, 0.5);
+        auto rightAscension = std::atan2(sun[1], sun[0])*180.0/std::numbers::pi + 360.0;
+        BOOST_CHECK_CLOSE(rightAscension, 281.3, 0.1);
+
+        // Half a year later it is near aphelion on the other side of the sky.
+        auto summer = sunPosition<double>(182.5*86400.0);
+        BOOST_CHECK_CLOSE(summer.norm(), 1.0167*astronomicalUnit, 0.05);
+        BOOST_CHECK_LT(summer.dot(sun), 0.0);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(moon_test) {
+        for (auto day = 0; day < 60; ++day) {
+            auto distance = moonPosition<double>(day*86400.0).norm();
+            BOOST_CHECK_GT(distance, 3.56e8);
+            BOOST_CHECK_LT(distance, 4.07e8);
+        }
+        // The Moon stays within about 5 degrees of the ecliptic, so within about 29 degrees of the equator.
+        for (auto hour = 0; hour < 24*30; hour += 7) {
+            auto moon = moonPosition<double>(hour*3600.0);
+            BOOST_CHECK_LT(std::abs(std::asin(moon[2]/moon.norm())), 29.0*std::numbers::pi/180.0);
+        }
+    }
+
+
+    BOOST_AUTO_TEST_CASE(cache_test) {
+        const auto start = 86400.0*365.25*26;
+        const auto end = start + 10.0*86400.0;
+        EphemerisCache<double> cache{start, end};
+        BOOST_CHECK_LE(cache.startTime(), start);
+        BOOST_CHECK_GE(cache.endTime(), end);
+
+        for (auto t = start; t <= end; t += 1234.5) {
+            BOOST_CHECK_SMALL((cache.sun(t) - sunPosition<double>(t)).norm(), 1.0);
+            BOOST_CHECK_SMALL((cache.moon(t) - moonPosition<double>(t)).norm(), 10.0);
+        }
+        BOOST_CHECK_SMALL((cache.moon(end) - moonPosition<double>(end)).norm(), 10.0);
+        BOOST_CHECK_THROW(cache.sun(start - 3601.0), std::out_of_range);
+        BOOST_CHECK_THROW(cache.moon(end + 3601.0), std::out_of_range);
+        BOOST_CHECK_THROW((EphemerisCache<double>{end, start}), std::invalid_argument);
+
+        EphemerisCache<float> single{start, end};
+        BOOST_CHECK_CLOSE(single.sun(start + 100.0).norm(), sunPosition<double>(start + 100.0).norm(), 1.0e-4);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,138 @@
+// -*- mode: c++ -*-
+////
+// Test the tracking filters
+//
+// Part of the orbit test suite
+//
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_DYN_LINK
+#pragma clang diagnostic pop
+
+#include <boost/test/unit_test.hpp>
+#include <random>
+#include <span>
+#include <vector>
+#include "filter.hpp"
+#include "orbit.hpp"
+#include "propagator.hpp"
+
+using vector3 = numutil::Vector3<double>;
+using namespace orbit;
+
+namespace {
+    const StateVector<double> truth{{1.2915326E+06, 8.4505435E+06, -2.033574E+06}, {-3289.3377, 2493.4338, -7662.0529}};
+
+    /// Initial estimate 1 km and 1 m/s off with matching covariance.
+    auto initialEstimate() -> FilterState<double>
+    {
+        FilterState<double> filter;
+        filter.state = truth;
+        filter.state.r += vector3{1000.0, -700.0, 500.0};
+        filter.state.v += vector3{-1.0, 0.5, 0.8};
+        for (auto i = 0; i < 3; ++i) {
+            filter.covariance[i][i] = 1.0e6;
+            filter.covariance[i + 3][i + 3] = 1.0;
+        }
+        return filter;
+    }
+
+    template<typename Filter>
+    auto trackPositions(const Filter &kalman) -> FilterState<double>
+    {
+        KeplerPropagator<double> propagator;
+        std::mt19937 generator{7};
+        std::normal_distribution<double> noise{0.0, 5.0};
+        auto filter = initialEstimate();
+        for (auto k = 1; k <= 60; ++k) {
+            auto t = 10.0*k;
+            auto position = propagator.propagate(truth, t).r;
+            for (auto i = 0; i < 3; ++i) position[i] += noise(generator);
+            auto nis = kalman.update(filter, PositionMeasurement<double>{t, position, 5.0});
+            BOOST_CHECK(nis >= 0.0);
+        }
+        return filter;
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE(filter_suite)
+
+    BOOST_AUTO_TEST_CASE(ekf_position_test) {
+        ExtendedKalmanFilter<double> kalman;
+        auto filter = trackPositions(kalman);
+        auto expected = KeplerPropagator<double>{}.propagate(truth, filter.time);
+        BOOST_CHECK_EQUAL(filter.time, 600.0);
+        BOOST_CHECK_SMALL((filter.state.r - expected.r).norm(), 10.0);
+        BOOST_CHECK_SMALL((filter.state.v - expected.v).norm(), 0.05);
+        BOOST_CHECK(filter.covariance[0][0] < 25.0);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(ukf_position_test) {
+        UnscentedKalmanFilter<double> kalman;
+        auto filter = trackPositions(kalman);
+        auto expected = KeplerPropagator<double>{}.propagate(truth, filter.time);
+        BOOST_CHECK_SMALL((filter.state.r - expected.r).norm(), 10.0);
+        BOOST_CHECK_SMALL((filter.state.v - expected.v).norm(), 0.05);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(range_and_range_rate_test) {
+        KeplerPropagator<double> propagator;
+        vector3 stations[] = {{6.4e6, 0.0, 0.0}, {0.0, 6.4e6, 0.0}, {0.0, 0.0, 6.4e6}, {-3.7e6, -3.7e6, 3.7e6}};
+        vector3 stationVelocity{};
+        ExtendedKalmanFilter<double> ekf;
+        UnscentedKalmanFilter<double> ukf;
+        auto extended = initialEstimate();
+        auto unscented = initialEstimate();
+        for (auto k = 1; k <= 200; ++k) {
+            auto t = 5.0*k;
+            auto state = propagator.propagate(truth, t);
+            const auto &station = stations[k % 4];
+            RangeMeasurement<double> range{t, station, (state.r - station).norm(), 1.0};
+            ekf.update(extended, range);
+            ukf.update(unscented, range);
+            RangeRateMeasurement<double> rate{t, station, stationVelocity, 0.0, 1.0e-3};
+            rate.rangeRate = rate.predict(state)[0];
+            ekf.update(extended, rate);
+            ukf.update(unscented, rate);
+        }
+        auto expected = propagator.propagate(truth, 1000.0);
+        BOOST_CHECK_SMALL((extended.state.r - expected.r).norm(), 10.0);
+        BOOST_CHECK_SMALL((unscented.state.r - expected.r).norm(), 10.0);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(j2_process_test) {
+        J2Propagator<double> truthModel;
+        ExtendedKalmanFilter<double, J2Propagator<double>> kalman{truthModel, 1.0e-8};
+        auto filter = initialEstimate();
+        for (auto k = 1; k <= 30; ++k) {
+            auto t = 20.0*k;
+            kalman.update(filter, PositionMeasurement<double>{t, truthModel.propagate(truth, t).r, 1.0});
+        }
+        BOOST_CHECK_SMALL((filter.state.r - truthModel.propagate(truth, 600.0).r).norm(), 2.0);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(filter_bank_test) {
+        KeplerPropagator<double> propagator;
+        std::vector<FilterState<double>> filters(32, initialEstimate());
+        std::vector<PositionMeasurement<double>> measurements(filters.size());
+        std::vector<double> nis(filters.size());
+        ExtendedKalmanFilter<double> kalman;
+        for (auto k = 1; k <= 20; ++k) {
+            auto t = 15.0*k;
+            for (auto &measurement: measurements) measurement = {t, propagator.propagate(truth, t).r, 1.0};
+            updateFilters(kalman, std::span(filters), std::span<const PositionMeasurement<double>>(measurements),
+                          std::span(nis), 4);
+        }
+        for (auto k = 0u; k < filters.size(); ++k) {
+            BOOST_CHECK_EQUAL(filters[k].time, 300.0);
+            BOOST_CHECK(nis[k] >= 0.0);
+            BOOST_CHECK_SMALL((filters[k].state.r - filters[0].state.r).norm(), 1.0e-9);
+        }
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
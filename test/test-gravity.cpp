@@ -0,0 +1,164 @@
+// -*- mode: c++ -*-
+////
+// Test orbit::GravityField
+//
+// Part of the orbit test suite
+//
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_DYN_LINK
+#pragma clang diagnostic pop
+
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include "constants.hpp"
+#include "gravity.hpp"
+#include "propagator.hpp"
+
+using vector3 = numutil::Vector3<double>;
+using namespace orbit;
+
+namespace {
+    const double radius = 6378136.3;
+
+    /// Field with Kaula rule sized random coefficients, 1e-5/n^2.
+    auto randomField(int degree, unsigned seed) -> GravityField<double>
+    {
+        GravityField<double> field{degree, muEarth, radius};
+        std::mt19937 generator{seed};
+        std::normal_distribution<double> gaussian{0.0, 1.0};
+        for (auto n = 2; n <= degree; ++n) {
+            for (auto m = 0; m <= n; ++m) {
+                field.setCoefficients(n, m, 1.0e-5*gaussian(generator)/(n*n),
+                                      m > 0 ? 1.0e-5*gaussian(generator)/(n*n) : 0.0);
+            }
+        }
+        return field;
+    }
+
+    /// Uniquely named file in the temporary directory, removed when the guard goes out of scope.
+    struct TemporaryFile {
+        std::filesystem::path path;
+
+        TemporaryFile(const std::string &stem, const std::string &extension)
+                : path{std::filesystem::temp_directory_path()
+                       / (stem + "-" + std::to_string(std::random_device{}()) + "-"
+                          + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + extension)} {}
+
+        TemporaryFile(const TemporaryFile &) = delete;
+
+        auto operator=(const TemporaryFile &) -> TemporaryFile & = delete;
+
+        ~TemporaryFile()
+        {
+            std::error_code ignored;
+            std::filesystem::remove(path, ignored);
+        }
+    };
+}
+
+
+BOOST_AUTO_TEST_SUITE(gravity_suite)
+
+    BOOST_AUTO_TEST_CASE(point_mass_test) {
+        GravityField<double> field{0, muEarth, radius};
+        GravityWorkspace<double> workspace;
+        vector3 r{7.0e6, -2.0e6, 3.0e6};
+        auto expected = r*(-muEarth/std::pow(r.norm(), 3));
+        BOOST_CHECK_SMALL((field.acceleration(r, workspace) - expected).norm()/expected.norm(), 1.0e-14);
+        BOOST_CHECK_CLOSE(field.potential(r, workspace), muEarth/r.norm(), 1.0e-12);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(j2_test) {
+        GravityField<double> field{2, muEarth, radius};
+        field.setCoefficients(2, 0, -earthJ2/std::sqrt(5.0), 0.0);
+        J2Propagator<double> zonal{muEarth, earthJ2, radius};
+        GravityWorkspace<double> workspace{2};
+        for (auto r: {vector3{7.0e6, -2.0e6, 3.0e6}, vector3{0.0, 0.0, 7.0e6}, vector3{4.0e6, 4.0e6, 0.0}}) {
+            auto difference = field.acceleration(r, workspace) - zonal.acceleration(r);
+            BOOST_CHECK_SMALL(difference.norm()/zonal.acceleration(r).norm(), 1.0e-13);
+        }
+    }
+
+
+    BOOST_AUTO_TEST_CASE(gradient_of_potential_test) {
+        auto field = randomField(12, 5);
+        GravityWorkspace<double> workspace{12};
+        // Includes points right on and next to the pole, where latitude based formulations are singular.
+        for (auto r: {vector3{7.0e6, -2.0e6, 3.0e6}, vector3{-1.0e6, 6.5e6, -2.5e6}, vector3{0.0, 0.0, 6.9e6},
+                      vector3{1.0, -1.0, -6.9e6}}) {
+            auto a = field.acceleration(r, workspace);
+            for (auto j = 0; j < 3; ++j) {
+                auto plus = r;
+                auto minus = r;
+                plus[j] += 1.0;
+                minus[j] -= 1.0;
+                auto derivative = (field.potential(plus, workspace) - field.potential(minus, workspace))/2.0;
+                BOOST_CHECK_SMALL(a[j] - derivative, 1.0e-6);
+            }
+        }
+    }
+
+
+    BOOST_AUTO_TEST_CASE(truncation_test) {
+        auto full = randomField(20, 9);
+        GravityField<double> low{4, full.gravitationalConstant(), full.referenceRadius()};
+        for (auto n = 0; n <= 4; ++n) {
+            for (auto m = 0; m <= n; ++m) low.setCoefficients(n, m, full.c(n, m), full.s(n, m));
+        }
+        GravityWorkspace<double> workspace;
+        vector3 r{3.0e6, 5.0e6, -4.0e6};
+        BOOST_CHECK_SMALL((full.acceleration(r, workspace, 4) - low.acceleration(r, workspace)).norm(), 1.0e-15);
+        BOOST_CHECK_EQUAL(workspace.degree(), 4);
+        full.acceleration(r, workspace);
+        BOOST_CHECK_EQUAL(workspace.degree(), 20);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(high_degree_test) {
+        auto field = randomField(120, 13);
+        GravityWorkspace<double> workspace{120};
+        for (auto r: {vector3{6.6e6, 1.0e5, 1.0e5}, vector3{1.0, 0.0, 6.6e6}}) {
+            auto a = field.acceleration(r, workspace);
+            auto pointMass = muEarth/r.dot(r);
+            BOOST_CHECK(std::isfinite(a.norm()));
+            BOOST_CHECK_SMALL(a.norm()/pointMass - 1.0, 1.0e-3);
+        }
+    }
+
+
+    BOOST_AUTO_TEST_CASE(load_test) {
+        TemporaryFile file{"test-gravity-field", ".gfc"};
+        {
+            std::ofstream out{file.path};
+            out << "product_type          gravity_field\n"
+                << "modelname             test\n"
+                << "earth_gravity_constant  0.3986004415E+15\n"
+                << "radius                  0.63781363E+07\n"
+                << "max_degree  3\n"
+                << "norm        fully_normalized\n"
+                << "key    L    M    C    S    sigma C    sigma S\n"
+                << "end_of_head ========================================\n"
+                << "gfc    0    0    1.0D+00    0.0D+00    0.0    0.0\n"
+                << "gfc    2    0   -0.484165143790815D-03    0.0D+00    0.0    0.0\n"
+                << "gfc    2    2    0.243938357328313D-05   -0.140027370385934D-05    0.0    0.0\n"
+                << "gfc    3    1    0.203046201047864D-05    0.248200415856872D-06    0.0    0.0\n";
+        }
+        auto field = GravityField<double>::load(file.path.string(), 2, 1.0, 1.0);
+
+        BOOST_CHECK_EQUAL(field.degree(), 2);
+        BOOST_CHECK_EQUAL(field.gravitationalConstant(), 3.986004415e14);
+        BOOST_CHECK_EQUAL(field.referenceRadius(), 6378136.3);
+        BOOST_CHECK_EQUAL(field.c(2, 0), -0.484165143790815e-3);
+        BOOST_CHECK_EQUAL(field.s(2, 2), -0.140027370385934e-5);
+
+        BOOST_CHECK_THROW(GravityField<double>::load("no-such-file.gfc", 2), std::runtime_error);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,106 @@
+// -*- mode: c++ -*-
+////
+// Test orbit::instrumentation
+//
+// Part of the orbit test suite
+//
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_DYN_LINK
+#pragma clang diagnostic pop
+
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include "instrumentation.hpp"
+#include "orbit.hpp"
+#include "propagator.hpp"
+
+using namespace orbit;
+namespace probes = orbit::instrumentation;
+
+
+BOOST_AUTO_TEST_SUITE(instrumentation_suite)
+
+    BOOST_AUTO_TEST_CASE(counting_test) {
+        probes::reset();
+        KeplerPropagator<double> propagator;
+        StateVector<double> state{{7.0e6, 0.0, 0.0}, {0.0, 6.0e3, 4.5e3}};
+        for (auto k = 0; k < 10; ++k) propagator.propagate(state, 100.0*k);
+        std::thread worker{[&] { propagator.propagate(state, 50.0); }};
+        worker.join();
+        propagator.propagate(StateVector<double>{}, 10.0);
+
+        auto snapshot = probes::snapshot();
+        const auto &kepler = snapshot.probes[static_cast<int>(probes::Probe::keplerPropagate)];
+        auto solves = std::accumulate(snapshot.keplerIterations.begin(), snapshot.keplerIterations.end(), 0ull);
+        BOOST_CHECK_EQUAL(snapshot.enabled, probes::enabled());
+        if (snapshot.enabled) {
+            // The exited thread's calls survive in the retired totals; the zero state yields NaN.
+            BOOST_CHECK_EQUAL(kepler.calls, 12u);
+            BOOST_CHECK_EQUAL(solves, 12u);
+            BOOST_CHECK_EQUAL(kepler.nonFinite, 1u);
+            BOOST_CHECK_EQUAL(std::accumulate(kepler.latency.begin(), kepler.latency.end(), 0ull), 12u);
+        } else {
+            BOOST_CHECK_EQUAL(kepler.calls, 0u);
+            BOOST_CHECK_EQUAL(solves, 0u);
+        }
+
+        probes::reset();
+        BOOST_CHECK_EQUAL(probes::snapshot().probes[static_cast<int>(probes::Probe::keplerPropagate)].calls, 0u);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(concurrent_reset_test) {
+        // Threads record while the main thread resets.  Calls finished before a reset must never reappear after it.
+        const auto probe = probes::Probe::j2Partials;
+        std::atomic<std::uint64_t> finished{0};
+        std::atomic<bool> stop{false};
+        std::vector<std::jthread> workers;
+        for (auto k = 0; k < 4; ++k) {
+            workers.emplace_back([&] {
+                while (!stop.load(std::memory_order_relaxed)) {
+                    probes::recordCall(probe, 100);
+                    finished.fetch_add(1, std::memory_order_release);
+                }
+            });
+        }
+        for (auto round = 0; round < 200; ++round) {
+            auto before = finished.load(std::memory_order_acquire);
+            probes::reset();
+            std::this_thread::yield();
+            auto calls = probes::snapshot().probes[static_cast<int>(probe)].calls;
+            auto after = finished.load(std::memory_order_acquire);
+            BOOST_REQUIRE_LE(calls, after - before + workers.size());
+        }
+        stop = true;
+        workers.clear();
+
+        auto before = finished.load();
+        probes::reset();
+        BOOST_CHECK_EQUAL(probes::snapshot().probes[static_cast<int>(probe)].calls, 0u);
+        BOOST_CHECK_GT(before, 0u);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(export_test) {
+        probes::Snapshot snapshot;
+        snapshot.enabled = true;
+        snapshot.probes[static_cast<int>(probes::Probe::stateFromElements)].calls = 3;
+        snapshot.probes[static_cast<int>(probes::Probe::stateFromElements)].latency[4] = 3;
+        snapshot.keplerIterations[2] = 5;
+
+        auto json = probes::toJson(snapshot);
+        BOOST_CHECK(json.starts_with("{\"enabled\":true,\"probes\":{\"state_from_elements\":{\"calls\":3,"));
+        BOOST_CHECK(json.find("\"kepler_iterations\":[0,0,5,") != std::string::npos);
+
+        auto text = probes::toPrometheus(snapshot);
+        BOOST_CHECK(text.find("orbit_calls_total{probe=\"state_from_elements\"} 3\n") != std::string::npos);
+        BOOST_CHECK(text.find("orbit_latency_seconds_count{probe=\"state_from_elements\"} 3\n") != std::string::npos);
+        BOOST_CHECK(text.find("orbit_kepler_iterations_bucket{le=\"1\"} 0\n") != std::string::npos);
+        BOOST_CHECK(text.find("orbit_kepler_iterations_bucket{le=\"2\"} 5\n") != std::string::npos);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
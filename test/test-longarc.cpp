@@ -0,0 +1,113 @@
+// -*- mode: c++ -*-
+////
+// Test orbit::SymplecticPropagator
+//
+// Part of the orbit test suite
+//
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_DYN_LINK
+#pragma clang diagnostic pop
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cmath>
+#include "constants.hpp"
+#include "longarc.hpp"
+#include "propagator.hpp"
+
+using vector3 = numutil::Vector3<double>;
+using namespace orbit;
+
+namespace {
+    const auto radius = earthEquatorialRadius*1.0e3;
+
+    /// Energy per unit mass in the point mass plus J2 field, conserved by the exact flow.
+    auto energy(const StateVector<double> &state) -> double
+    {
+        auto r = state.r.norm();
+        auto sinLatitude = state.r[2]/r;
+        return state.v.dot(state.v)/2.0 - muEarth/r
+               + muEarth*earthJ2*radius*radius/(2.0*r*r*r)*(3.0*sinLatitude*sinLatitude - 1.0);
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE(longarc_suite)
+
+    BOOST_AUTO_TEST_CASE(two_body_test) {
+        StateVector<double> state{KeplerianElements<double>{9.0e6, 0.2, 0.8, 0.1, 0.2, 0.3}};
+        SymplecticPropagator<double> propagator{muEarth, 0.0};
+        auto result = propagator.propagate(state, 86400.0);
+        auto exact = KeplerPropagator<double>{}.propagate(state, 86400.0);
+        BOOST_CHECK_SMALL((result.r - exact.r).norm(), 1.0e-3);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(accuracy_test) {
+        // Against Cowell with a small step, for a LEO and an eccentric orbit.
+        for (const auto &elements: {KeplerianElements<double>{7078.0e3, 0.01, 1.0, 0.3, 0.2, 0.1},
+                                    KeplerianElements<double>{26560.0e3, 0.6, 1.1, 2.0, 4.0, 0.5}}) {
+            StateVector<double> state{elements};
+            auto reference = J2Propagator<double>{muEarth, earthJ2, radius, 2.0}.propagate(state, 86400.0);
+            auto result = SymplecticPropagator<double>{}.propagate(state, 86400.0);
+            BOOST_CHECK_SMALL((result.r - reference.r).norm(), 0.1);
+            BOOST_CHECK_SMALL((result.v - reference.v).norm(), 1.0e-4);
+        }
+    }
+
+
+    BOOST_AUTO_TEST_CASE(conservation_test) {
+        // A thousand LEO revolutions with eight steps each: energy and the polar angular momentum do not wander.
+        StateVector<double> state{KeplerianElements<double>{7078.0e3, 0.01, 1.0, 0.3, 0.2, 0.1}};
+        SymplecticPropagator<double> propagator{muEarth, earthJ2, radius, 8};
+        auto initialEnergy = energy(state);
+        auto initialMomentum = state.angularMomentum()[2];
+        auto period = 2.0*std::numbers::pi*std::sqrt(std::pow(7078.0e3, 3)/muEarth);
+        auto worst = 0.0;
+        for (auto block = 0; block < 100; ++block) {
+            state = propagator.propagate(state, 10.0*period);
+            worst = std::max(worst, std::abs(energy(state)/initialEnergy - 1.0));
+        }
+        BOOST_CHECK_SMALL(worst, 1.0e-6);
+        BOOST_CHECK_SMALL(state.angularMomentum()[2]/initialMomentum - 1.0, 1.0e-9);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(reversibility_test) {
+        StateVector<double> state{KeplerianElements<double>{8.0e6, 0.05, 0.5, 1.0, 2.0, 3.0}};
+        SymplecticPropagator<double> propagator;
+        auto back = propagator.propagate(propagator.propagate(state, 20000.0), -20000.0);
+        BOOST_CHECK_SMALL((back.r - state.r).norm(), 1.0e-4);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(luni_solar_test) {
+        // GEO for two days against fourth order Runge-Kutta on the same forces with a ten second step.
+        const auto start = 86400.0*9000.0;
+        EphemerisCache<double> ephemeris{start, start + 3.0*86400.0};
+        LuniSolarForce<double> luniSolar{ephemeris, 0.02, 1.3};
+        J2Propagator<double> gravity;
+        auto acceleration = [&](double t, const vector3 &r) { return gravity.acceleration(r) + luniSolar.acceleration(t, r); };
+
+        StateVector<double> state{KeplerianElements<double>{42164.0e3, 0.001, 0.01, 0.0, 0.0, 0.0}};
+        auto r = state.r;
+        auto v = state.v;
+        const auto h = 10.0;
+        for (auto t = start; t < start + 2.0*86400.0 - 1.0; t += h) {
+            auto a1 = acceleration(t, r);
+            auto a2 = acceleration(t + h/2, r + v*(h/2));
+            auto a3 = acceleration(t + h/2, r + v*(h/2) + a1*(h*h/4));
+            auto a4 = acceleration(t + h, r + v*h + a2*(h*h/2));
+            r += (v + (a1 + a2 + a3)*(h/6))*h;
+            v += (a1 + 2.0*a2 + 2.0*a3 + a4)*(h/6);
+        }
+
+        SymplecticPropagator<double> propagator{muEarth, earthJ2, radius, 32, &luniSolar};
+        auto result = propagator.propagate(state, start, 2.0*86400.0);
+        auto withoutThirdBodies = SymplecticPropagator<double>{}.propagate(state, start, 2.0*86400.0);
+        BOOST_CHECK_GT((withoutThirdBodies.r - r).norm(), 1.0e3);
+        BOOST_CHECK_SMALL((result.r - r).norm(), 1.0);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -105,5 +105,35 @@ BOOST_AUTO_TEST_SUITE(orbit_suite)
         BOOST_CHECK_CLOSE(specMomentum, expectedSpecificMomentum, 1.0);
     }
 
+
+    BOOST_AUTO_TEST_CASE(state_vector_to_kepler_test) {
+        auto i = (63.4/180.0)*pi;
+        KeplerianElements elements{26.61027E6, 0.74, i, 4.4413224, 3.0*pi/4.0, 1.0471976};
+        KeplerianElements recovered{StateVector{elements}};
+        BOOST_CHECK_CLOSE(recovered.semiMajorAxis, elements.semiMajorAxis, 1.0e-10);
+        BOOST_CHECK_CLOSE(recovered.eccentricity, elements.eccentricity, 1.0e-10);
+        BOOST_CHECK_CLOSE(recovered.inclination, elements.inclination, 1.0e-10);
+        BOOST_CHECK_CLOSE(recovered.rightAscensionAscendingNode, elements.rightAscensionAscendingNode, 1.0e-10);
+        BOOST_CHECK_CLOSE(recovered.argumentOfPeriapsis, elements.argumentOfPeriapsis, 1.0e-10);
+        BOOST_CHECK_CLOSE(recovered.trueAnomaly, elements.trueAnomaly, 1.0e-10);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(singular_elements_test) {
+        // Circular, equatorial and retrograde equatorial orbits still convert back to the same state.
+        for (const auto &elements: {KeplerianElements{7.0e6, 0.0, 0.9, 1.0, 0.0, 2.0},
+                                    KeplerianElements{7.0e6, 0.1, 0.0, 0.0, 1.0, 2.0},
+                                    KeplerianElements{7.0e6, 0.0, 0.0, 0.0, 0.0, 2.0},
+                                    KeplerianElements{7.0e6, 0.1, pi, 0.0, 1.0, 2.0}}) {
+            StateVector state{elements};
+            StateVector again{KeplerianElements{state}};
+            BOOST_CHECK_SMALL((again.r - state.r).norm(), 1.0e-6);
+            BOOST_CHECK_SMALL((again.v - state.v).norm(), 1.0e-9);
+        }
+        KeplerianElements circular{StateVector{KeplerianElements{7.0e6, 0.0, 0.9, 1.0, 0.0, 2.0}}};
+        BOOST_CHECK_EQUAL(circular.argumentOfPeriapsis, 0.0);
+        BOOST_CHECK_CLOSE(circular.trueAnomaly, 2.0, 1.0e-10);
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,95 @@
+// -*- mode: c++ -*-
+////
+// Test third body, shadow and solar radiation pressure models
+//
+// Part of the orbit test suite
+//
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_DYN_LINK
+#pragma clang diagnostic pop
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include "constants.hpp"
+#include "perturbations.hpp"
+
+using vector3 = numutil::Vector3<double>;
+using namespace orbit;
+
+
+BOOST_AUTO_TEST_SUITE(perturbations_suite)
+
+    BOOST_AUTO_TEST_CASE(third_body_test) {
+        vector3 moon{3.8e8, 0.0, 0.0};
+        for (auto r: {vector3{4.2e7, 0.0, 0.0}, vector3{-4.2e7, 0.0, 0.0}, vector3{1.0e6, 6.9e6, -2.0e6}}) {
+            auto d = moon - r;
+            auto direct = (d*(1.0/std::pow(d.norm(), 3)) - moon*(1.0/std::pow(moon.norm(), 3)))*muMoon;
+            auto a = thirdBodyAcceleration(r, moon, muMoon);
+            BOOST_CHECK_SMALL((a - direct).norm()/direct.norm(), 1.0e-9);
+        }
+        // Tidal: pulled toward the Moon on the near side, away from it on the far side.
+        BOOST_CHECK_GT(thirdBodyAcceleration(vector3{4.2e7, 0.0, 0.0}, moon, muMoon)[0], 0.0);
+        BOOST_CHECK_LT(thirdBodyAcceleration(vector3{-4.2e7, 0.0, 0.0}, moon, muMoon)[0], 0.0);
+
+        // Far bodies stay accurate in float.
+        numutil::Vector3<double> sun{1.2e11, -8.0e10, 3.0e10};
+        vector3 r{3.0e7, 2.0e7, -1.0e7};
+        auto exact = thirdBodyAcceleration(r, sun, muSun);
+        auto single = thirdBodyAcceleration(numutil::Vector3<float>{3.0e7f, 2.0e7f, -1.0e7f},
+                                            numutil::Vector3<float>{1.2e11f, -8.0e10f, 3.0e10f}, float(muSun));
+        for (auto k = 0; k < 3; ++k) BOOST_CHECK_SMALL(single[k] - exact[k], 1.0e-4*exact.norm());
+    }
+
+
+    BOOST_AUTO_TEST_CASE(shadow_test) {
+        vector3 sun{astronomicalUnit, 0.0, 0.0};
+        BOOST_CHECK_EQUAL(shadowFunction(vector3{7.0e6, 0.0, 0.0}, sun), 1.0);
+        BOOST_CHECK_EQUAL(shadowFunction(vector3{0.0, 7.0e6, 0.0}, sun), 1.0);
+        BOOST_CHECK_EQUAL(shadowFunction(vector3{-7.0e6, 0.0, 0.0}, sun), 0.0);
+
+        // Leaving the shadow sideways at GEO the visible fraction climbs from 0 to 1 through the penumbra.
+        auto previous = 0.0;
+        auto partial = 0;
+        for (auto y = 6.0e6; y < 7.0e6; y += 1.0e3) {
+            auto nu = shadowFunction(vector3{-4.2e7, y, 0.0}, sun);
+            BOOST_CHECK_GE(nu, previous);
+            if (nu > 0.0 && nu < 1.0) ++partial;
+            previous = nu;
+        }
+        BOOST_CHECK_EQUAL(previous, 1.0);
+        BOOST_CHECK_GT(partial, 100);
+
+        // Beyond the tip of the umbra the Earth covers only the middle of the Sun.
+        auto annular = shadowFunction(vector3{-2.0e9, 0.0, 0.0}, sun);
+        BOOST_CHECK_GT(annular, 0.0);
+        BOOST_CHECK_LT(annular, 1.0);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(radiation_pressure_test) {
+        vector3 sun{astronomicalUnit, 0.0, 0.0};
+        auto a = solarRadiationPressure(vector3{0.0, 4.2e7, 0.0}, sun, 0.02, 1.3);
+        BOOST_CHECK_LT(a[0], 0.0);
+        BOOST_CHECK_CLOSE(a.norm(), solarPressure*1.3*0.02, 0.1);
+        BOOST_CHECK_EQUAL(solarRadiationPressure(vector3{-7.0e6, 0.0, 0.0}, sun, 0.02, 1.3).norm(), 0.0);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(luni_solar_test) {
+        const auto t = 86400.0*9000.0;
+        EphemerisCache<double> cache{t - 86400.0, t + 86400.0};
+        LuniSolarForce<double> force{cache, 0.02, 1.3};
+        vector3 r{4.2e7, 1.0e6, 0.0};
+        auto sun = cache.sun(t);
+        auto expected = thirdBodyAcceleration(r, sun, muSun) + thirdBodyAcceleration(r, cache.moon(t), muMoon)
+                        + solarRadiationPressure(r, sun, 0.02, 1.3);
+        BOOST_CHECK_SMALL((force.acceleration(t, r) - expected).norm(), 1.0e-20);
+
+        // At GEO the Moon and Sun each perturb at the micro g level.
+        auto gravityOnly = LuniSolarForce<double>{cache}.acceleration(t, r).norm();
+        BOOST_CHECK_GT(gravityOnly, 1.0e-6);
+        BOOST_CHECK_LT(gravityOnly, 2.0e-5);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,169 @@
+// -*- mode: c++ -*-
+////
+// Test orbit::KeplerPropagator
+//
+// Part of the orbit test suite
+//
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_DYN_LINK
+#pragma clang diagnostic pop
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <numbers>
+#include "constants.hpp"
+#include "orbit.hpp"
+#include "propagator.hpp"
+
+using vector3 = numutil::Vector3<double>;
+using namespace orbit;
+using namespace std::numbers;
+
+
+BOOST_AUTO_TEST_SUITE(propagator_suite)
+
+    BOOST_AUTO_TEST_CASE(full_revolution_test) {
+        auto a = 26.61027E6; // meters
+        KeplerianElements<double> elements{a, 0.74, (63.4/180.0)*pi, 4.4413224, 3.0*pi/4.0, 1.0471976};
+        StateVector<double> state{elements};
+        KeplerPropagator<double> propagator;
+
+        auto period = 2.0*pi*std::sqrt(a*a*a/muEarth);
+        auto after = propagator.propagate(state, period);
+        BOOST_CHECK_SMALL((after.r - state.r).norm()/state.r.norm(), 1.0e-10);
+        BOOST_CHECK_SMALL((after.v - state.v).norm()/state.v.norm(), 1.0e-10);
+
+        // Half a revolution from periapsis lands on apoapsis.
+        KeplerianElements<double> periapsis{a, 0.74, 0.3, 0.2, 0.1, 0.0};
+        auto apoapsis = propagator.propagate(StateVector<double>{periapsis}, period/2.0);
+        BOOST_CHECK_CLOSE(apoapsis.r.norm(), a*(1.0 + 0.74), 1.0e-9);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(conservation_test) {
+        KeplerPropagator<double> propagator;
+        // Elliptic, near parabolic and hyperbolic departures from the same position.
+        for (auto speed: {7.5e3, 11.18e3, 15.0e3}) {
+            StateVector<double> state{{7.0e6, 0.0, 0.0}, {0.0, speed*0.8, speed*0.6}};
+            auto energy = state.v*state.v/2.0 - muEarth/state.r.norm();
+            for (auto dt: {-3000.0, 60.0, 5400.0, 86400.0}) {
+                auto later = propagator.propagate(state, dt);
+                BOOST_CHECK_CLOSE(later.v*later.v/2.0 - muEarth/later.r.norm(), energy, 1.0e-8);
+                BOOST_CHECK_SMALL((later.angularMomentum() - state.angularMomentum()).norm()
+                                  /state.specificAngularMomentum(), 1.0e-11);
+                auto back = propagator.propagate(later, -dt);
+                BOOST_CHECK_SMALL((back.r - state.r).norm()/state.r.norm(), 1.0e-10);
+            }
+        }
+    }
+
+
+    BOOST_AUTO_TEST_CASE(state_transition_matrix_test) {
+        KeplerPropagator<double> propagator;
+        StateVector<double> state{{1.2915326E+06, 8.4505435E+06, -2.033574E+06}, {-3289.3377, 2493.4338, -7662.0529}};
+
+        for (auto dt: {300.0, 7200.0, -4000.0}) {
+            Matrix6x6<double> stm;
+            propagator.propagate(state, dt, stm);
+
+            // Central differences on each component of the initial state.
+            for (auto j = 0; j < 6; ++j) {
+                auto step = j < 3 ? 10.0 : 0.01;
+                auto plus = state;
+                auto minus = state;
+                if (j < 3) {
+                    plus.r[j] += step;
+                    minus.r[j] -= step;
+                } else {
+                    plus.v[j - 3] += step;
+                    minus.v[j - 3] -= step;
+                }
+                auto high = propagator.propagate(plus, dt);
+                auto low = propagator.propagate(minus, dt);
+                for (auto i = 0; i < 3; ++i) {
+                    auto dr = (high.r[i] - low.r[i])/(2.0*step);
+                    auto dv = (high.v[i] - low.v[i])/(2.0*step);
+                    BOOST_CHECK_SMALL(stm[i][j] - dr, 1.0e-5*(1.0 + std::abs(dr)));
+                    BOOST_CHECK_SMALL(stm[i + 3][j] - dv, 1.0e-5*(1.0 + std::abs(dv)));
+                }
+            }
+        }
+    }
+
+
+    BOOST_AUTO_TEST_CASE(single_precision_test) {
+        KeplerPropagator<float> propagator{static_cast<float>(muEarth)};
+        StateVector<float> state{{7.0e6F, 0.0F, 0.0F}, {0.0F, 6.0e3F, 4.5e3F}};
+        auto later = propagator.propagate(state, 1000.0F);
+        auto back = propagator.propagate(later, -1000.0F);
+        BOOST_CHECK_SMALL((back.r - state.r).norm()/state.r.norm(), 1.0e-4F);
+        BOOST_CHECK(KeplerPropagator<float>::lastIterations() < KeplerPropagator<float>::maxIterations);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(j2_gradient_test) {
+        J2Propagator<double> propagator;
+        vector3 r{4.0e6, -3.0e6, 5.0e6};
+        double gradient[3][3];
+        auto a = propagator.acceleration(r, gradient);
+        BOOST_CHECK_SMALL((a - propagator.acceleration(r)).norm(), 1.0e-15);
+        for (auto j = 0; j < 3; ++j) {
+            auto plus = r;
+            auto minus = r;
+            plus[j] += 1.0;
+            minus[j] -= 1.0;
+            auto difference = (propagator.acceleration(plus) - propagator.acceleration(minus))*0.5;
+            for (auto i = 0; i < 3; ++i) BOOST_CHECK_CLOSE(gradient[i][j], difference[i], 1.0e-5);
+        }
+    }
+
+
+    BOOST_AUTO_TEST_CASE(j2_propagation_test) {
+        // Without J2 the integrator must reproduce the Kepler solution.
+        StateVector<double> state{{7.0e6, 0.0, 0.0}, {0.0, 6.0e3, 4.5e3}};
+        J2Propagator<double> pointMass{muEarth, 0.0, 6378137.0, 10.0};
+        auto integrated = pointMass.propagate(state, 3000.0);
+        auto exact = KeplerPropagator<double>{}.propagate(state, 3000.0);
+        BOOST_CHECK_SMALL((integrated.r - exact.r).norm(), 1.0e-2);
+
+        // J2 regresses the node of a prograde orbit westward.
+        J2Propagator<double> propagator;
+        Matrix6x6<double> stm;
+        auto later = propagator.propagate(state, 6000.0, stm);
+        auto nodeBefore = std::atan2(state.angularMomentum()[0], -state.angularMomentum()[1]);
+        auto nodeAfter = std::atan2(later.angularMomentum()[0], -later.angularMomentum()[1]);
+        BOOST_CHECK(nodeAfter < nodeBefore);
+
+        auto again = propagator.propagate(state, 6000.0);
+        BOOST_CHECK_SMALL((again.r - later.r).norm(), 1.0e-6);
+        auto plus = state;
+        plus.v[1] += 0.01;
+        auto shifted = propagator.propagate(plus, 6000.0);
+        for (auto i = 0; i < 3; ++i) BOOST_CHECK_CLOSE(stm[i][4], (shifted.r[i] - later.r[i])/0.01, 0.1);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(secular_j2_test) {
+        KeplerianElements<double> elements{7.0e6, 0.1, 0.9, 0.5, 1.2, 0.7};
+        StateVector<double> state{elements};
+        SecularJ2Propagator<double> twoBody{elements, 100.0, 0.0};
+        auto atEpoch = twoBody.propagate(100.0);
+        BOOST_CHECK_SMALL((atEpoch.r - state.r).norm(), 1.0e-3);
+        BOOST_CHECK_SMALL((atEpoch.v - state.v).norm(), 1.0e-6);
+        auto later = KeplerPropagator<double>{}.propagate(state, 5000.0);
+        BOOST_CHECK_SMALL((twoBody.position(5100.0) - later.r).norm(), 1.0e-3);
+        BOOST_CHECK_SMALL((twoBody.propagate(5100.0).v - later.v).norm(), 1.0e-6);
+
+        // A sun synchronous orbit turns its node eastward once a year.
+        KeplerianElements<double> sunSynchronous{7078.0e3, 0.001, 98.19*pi/180.0, 0.0, 0.0, 0.0};
+        SecularJ2Propagator<double> propagator{sunSynchronous};
+        auto node = [&](double t) {
+            auto h = propagator.propagate(t).angularMomentum();
+            return std::atan2(h[0], -h[1]);
+        };
+        BOOST_CHECK_CLOSE((node(86400.0) - node(0.0))*180.0/pi, 360.0/365.2422, 2.0);
+        BOOST_CHECK_CLOSE(propagator.meanAnomaly(propagator.timeOfMeanAnomaly(10.0)), 10.0, 1.0e-12);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,113 @@
+// -*- mode: c++ -*-
+////
+// Test numutil::Philox4x32 and the element samplers
+//
+// Part of the orbit test suite
+//
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_DYN_LINK
+#pragma clang diagnostic pop
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <cstdint>
+#include "orbit.hpp"
+#include "random.hpp"
+#include "sampling.hpp"
+
+using namespace orbit;
+
+namespace {
+    struct Moments {
+        std::uint64_t count = 0;
+        double sum = 0.0;
+        double sumSquares = 0.0;
+        double maxRadius = 0.0;
+    };
+
+    auto addSample = [](Moments &m, const KeplerianElements<double> &elements, const StateVector<double> &state) {
+        ++m.count;
+        m.sum += elements.semiMajorAxis;
+        m.sumSquares += elements.semiMajorAxis*elements.semiMajorAxis;
+        m.maxRadius = std::max(m.maxRadius, state.r.norm());
+    };
+
+    auto mergeMoments = [](Moments &into, const Moments &from) {
+        into.count += from.count;
+        into.sum += from.sum;
+        into.sumSquares += from.sumSquares;
+        into.maxRadius = std::max(into.maxRadius, from.maxRadius);
+    };
+}
+
+
+BOOST_AUTO_TEST_SUITE(sampling_suite)
+
+    BOOST_AUTO_TEST_CASE(philox_known_answer_test) {
+        // Known answer vectors from the Random123 distribution.
+        numutil::Philox4x32 zero{numutil::Philox4x32::keyType{0, 0}};
+        auto bits = zero({0, 0, 0, 0});
+        BOOST_CHECK_EQUAL(bits[0], 0x6627e8d5u);
+        BOOST_CHECK_EQUAL(bits[1], 0xe169c58du);
+        BOOST_CHECK_EQUAL(bits[2], 0xbc57ac4cu);
+        BOOST_CHECK_EQUAL(bits[3], 0x9b00dbd8u);
+
+        numutil::Philox4x32 ones{numutil::Philox4x32::keyType{0xffffffffu, 0xffffffffu}};
+        bits = ones({0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu});
+        BOOST_CHECK_EQUAL(bits[0], 0x408f276du);
+        BOOST_CHECK_EQUAL(bits[1], 0x41c83b0eu);
+        BOOST_CHECK_EQUAL(bits[2], 0xa20bc7c6u);
+        BOOST_CHECK_EQUAL(bits[3], 0x6d5451fdu);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(grid_test) {
+        ElementGrid<double> grid{{GridAxis<double>{7.0e6, 8.0e6, 3}, {0.0, 0.2, 2}, {0.1, 0.1, 1},
+                                  {0.0, 1.0, 5}, {0.5, 0.5, 1}, {0.0, 3.0, 4}}};
+        BOOST_CHECK_EQUAL(grid.size(), 3u*2u*5u*4u);
+
+        auto last = grid(grid.size() - 1);
+        BOOST_CHECK_EQUAL(last.semiMajorAxis, 8.0e6);
+        BOOST_CHECK_EQUAL(last.eccentricity, 0.2);
+        BOOST_CHECK_EQUAL(last.rightAscensionAscendingNode, 1.0);
+        BOOST_CHECK_EQUAL(last.trueAnomaly, 3.0);
+
+        // True anomaly varies fastest, then node.
+        auto sample = grid(5);
+        BOOST_CHECK_EQUAL(sample.semiMajorAxis, 7.0e6);
+        BOOST_CHECK_EQUAL(sample.rightAscensionAscendingNode, 0.25);
+        BOOST_CHECK_EQUAL(sample.trueAnomaly, 1.0);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(dispersion_statistics_test) {
+        KeplerianElements<double> nominal{7.0e6, 0.01, 0.9, 1.0, 2.0, 3.0};
+        ElementDispersion<double> dispersion{nominal, {1.0e3, 0.001, 0.0, 0.0, 0.0, 0.1}, 200000, 11};
+
+        auto moments = sampleReduce(dispersion, Moments{}, addSample, mergeMoments, 2, 4096);
+        auto mean = moments.sum/moments.count;
+        auto sigma = std::sqrt(moments.sumSquares/moments.count - mean*mean);
+        BOOST_CHECK_EQUAL(moments.count, 200000u);
+        BOOST_CHECK_SMALL(mean - 7.0e6, 10.0);
+        BOOST_CHECK_CLOSE(sigma, 1.0e3, 1.0);
+        BOOST_CHECK_EQUAL(dispersion(12345).inclination, 0.9);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(reproducible_test) {
+        KeplerianElements<double> nominal{2.6e7, 0.5, 1.1, 1.0, 2.0, 0.0};
+        ElementDispersion<double> dispersion{nominal, {1.0e4, 0.05, 0.01, 0.1, 0.1, 3.0}, 50000, 3};
+
+        auto serial = sampleReduce(dispersion, Moments{}, addSample, mergeMoments, 1, 1000);
+        auto parallel = sampleReduce(dispersion, Moments{}, addSample, mergeMoments, 4, 1000);
+        BOOST_CHECK_EQUAL(serial.count, parallel.count);
+        BOOST_CHECK_EQUAL(serial.sum, parallel.sum);
+        BOOST_CHECK_EQUAL(serial.sumSquares, parallel.sumSquares);
+        BOOST_CHECK_EQUAL(serial.maxRadius, parallel.maxRadius);
+
+        ElementDispersion<double> reseeded{nominal, {1.0e4, 0.05, 0.01, 0.1, 0.1, 3.0}, 50000, 4};
+        BOOST_CHECK(reseeded(7).semiMajorAxis != dispersion(7).semiMajorAxis);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
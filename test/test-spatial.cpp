@@ -0,0 +1,152 @@
+// -*- mode: c++ -*-
+////
+// Test orbit::OrbitGeometry and orbit::OrbitIndex
+//
+// Part of the orbit test suite
+//
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
+#define BOOST_TEST_DYN_LINK
+#pragma clang diagnostic pop
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+#include <vector>
+#include "random.hpp"
+#include "spatial.hpp"
+
+using namespace orbit;
+using vector3 = numutil::Vector3<double>;
+
+namespace {
+    auto randomCatalog(std::size_t count) -> std::vector<KeplerianElements<double>>
+    {
+        numutil::Philox4x32 generator{5};
+        std::vector<KeplerianElements<double>> catalog;
+        for (std::size_t k = 0; k < count; ++k) {
+            auto w = generator.words(k, 0);
+            auto u = numutil::Philox4x32::uniform(w[0]);
+            auto v = numutil::Philox4x32::uniform(w[1]);
+            auto a = 6.8e6 + 3.6e7*u*u;
+            auto e = k % 8 == 0 ? 0.7*v*(1.0 - 6.6e6/a) : 0.02*v;
+            catalog.emplace_back(a, e, std::numbers::pi*v, 6.28*u, 6.28*v, 0.0);
+        }
+        return catalog;
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE(spatial_suite)
+
+    BOOST_AUTO_TEST_CASE(geometry_test) {
+        KeplerianElements<double> elements{2.0e7, 0.5, 1.0, 0.4, 2.0, 0.0};
+        OrbitGeometry<double> geometry{elements};
+        BOOST_CHECK_CLOSE(geometry.perigeeRadius(), 1.0e7, 1.0e-12);
+        BOOST_CHECK_CLOSE(geometry.apogeeRadius(), 3.0e7, 1.0e-12);
+        BOOST_CHECK_SMALL((geometry.normal() - StateVector<double>{elements}.angularMomentum().unit()).norm(), 1.0e-12);
+
+        // Against dense sampling of the path, which also has to stay inside the box.
+        auto low = geometry.boxCorner(-1);
+        auto high = geometry.boxCorner(1);
+        const vector3 points[] = {{1.0e7, 2.0e6, -3.0e6}, {0.0, 0.0, 1.0e5}, {-4.0e7, 1.0e7, 2.0e7}};
+        for (const auto &point: points) {
+            auto closest = 1.0e300;
+            for (auto k = 0; k < 200000; ++k) {
+                KeplerianElements<double> sample{2.0e7, 0.5, 1.0, 0.4, 2.0, 2.0*std::numbers::pi*k/200000.0};
+                auto r = StateVector<double>{sample}.r;
+                closest = std::min(closest, (r - point).norm());
+                for (auto j = 0; j < 3; ++j) {
+                    BOOST_CHECK_GE(r[j], low[j] - 1.0e-6);
+                    BOOST_CHECK_LE(r[j], high[j] + 1.0e-6);
+                }
+            }
+            BOOST_CHECK_LE(geometry.distanceTo(point), closest);
+            BOOST_CHECK_CLOSE(geometry.distanceTo(point), closest, 1.0e-3);
+        }
+
+        BOOST_CHECK_THROW(OrbitGeometry<double>(KeplerianElements<double>{-2.0e7, 1.5, 1.0, 0.0, 0.0, 0.0}),
+                          std::invalid_argument);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(eccentric_distance_test) {
+        // Points around the far end of a very eccentric ellipse, where the distance has two local minima.
+        KeplerianElements<double> elements{2.0e7, 0.95, 0.7, 1.1, 2.5, 0.0};
+        OrbitGeometry<double> geometry{elements};
+        auto at = [&](double nu) {
+            return StateVector<double>{KeplerianElements<double>{2.0e7, 0.95, 0.7, 1.1, 2.5, nu}}.r;
+        };
+        auto apogee = at(std::numbers::pi);
+        auto side = at(std::numbers::pi/2).unit();
+        auto normal = geometry.normal();
+        const vector3 points[] = {0.9*apogee, 0.9*apogee + 3.0e5*side, 0.8*apogee - 1.5e6*side,
+                                  0.97*apogee + 4.0e5*side + 2.0e5*normal, 1.02*apogee - 2.0e6*side,
+                                  0.5*apogee + 5.0e6*side};
+        for (const auto &point: points) {
+            auto closest = 1.0e300;
+            for (auto k = 0; k < 1000000; ++k) {
+                closest = std::min(closest, (at(2.0*std::numbers::pi*k/1.0e6) - point).norm());
+            }
+            BOOST_CHECK_LE(geometry.distanceTo(point), closest*(1 + 1.0e-12));
+            BOOST_CHECK_CLOSE(geometry.distanceTo(point), closest, 1.0e-4);
+        }
+    }
+
+
+    BOOST_AUTO_TEST_CASE(queries_match_scan_test) {
+        auto catalog = randomCatalog(5000);
+        OrbitIndex<double> index{catalog};
+        BOOST_REQUIRE_EQUAL(index.size(), catalog.size());
+
+        std::vector<OrbitGeometry<double>> geometries;
+        for (const auto &elements: catalog) geometries.emplace_back(elements);
+
+        const double bands[][2] = {{6.9e6, 7.0e6}, {4.2e7, 4.22e7}, {2.0e7, 2.0e7}, {1.0e6, 2.0e6}};
+        for (const auto &band: bands) {
+            std::vector<std::size_t> expected;
+            for (std::size_t k = 0; k < geometries.size(); ++k) {
+                if (geometries[k].perigeeRadius() <= band[1] && geometries[k].apogeeRadius() >= band[0]) {
+                    expected.push_back(k);
+                }
+            }
+            auto found = index.shell(band[0], band[1]);
+            BOOST_CHECK_EQUAL_COLLECTIONS(found.begin(), found.end(), expected.begin(), expected.end());
+        }
+
+        numutil::Philox4x32 generator{9};
+        auto totalFound = 0ul;
+        for (auto query = 0; query < 40; ++query) {
+            auto w = generator.words(query, 0);
+            auto radius = query % 2 == 0 ? 7.2e6 : 2.6e7;
+            auto z = 2.0*numutil::Philox4x32::uniform(w[0]) - 1.0;
+            auto phi = 2.0*std::numbers::pi*numutil::Philox4x32::uniform(w[1]);
+            vector3 point{radius*std::sqrt(1 - z*z)*std::cos(phi), radius*std::sqrt(1 - z*z)*std::sin(phi), radius*z};
+            auto distance = 5.0e4;
+
+            std::vector<std::size_t> expected;
+            for (std::size_t k = 0; k < geometries.size(); ++k) {
+                if (geometries[k].distanceTo(point) <= distance) expected.push_back(k);
+            }
+            auto found = index.near(point, distance);
+            BOOST_CHECK_EQUAL_COLLECTIONS(found.begin(), found.end(), expected.begin(), expected.end());
+            BOOST_CHECK_LT(OrbitIndex<double>::lastVisited().first, catalog.size()/4);
+            totalFound += found.size();
+        }
+        BOOST_CHECK_GT(totalFound, 0u);
+        BOOST_CHECK_CLOSE(index.geometry(17).apogeeRadius(), geometries[17].apogeeRadius(), 1.0e-12);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(single_precision_test) {
+        std::vector<KeplerianElements<float>> catalog;
+        for (auto k = 0; k < 100; ++k) catalog.emplace_back(7.0e6f + 1.0e4f*k, 0.001f, 0.03f*k, 0.06f*k, 0.0f, 0.0f);
+        OrbitIndex<float> index{catalog};
+        auto found = index.shell(7.2e6f, 7.3e6f);
+        BOOST_CHECK_GE(found.size(), 9u);
+        BOOST_CHECK_LE(found.size(), 12u);
+        BOOST_CHECK(OrbitIndex<float>{std::vector<KeplerianElements<float>>{}}.near({1, 2, 3}, 1.0f).empty());
+    }
+
+BOOST_AUTO_TEST_SUITE_END()